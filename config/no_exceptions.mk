@@ -0,0 +1,5 @@
+include $(config_dir)rel.mk
+
+# Build without C++ exceptions support. In this configuration the library aborts the program
+# instead of throwing, so the non-throwing API, like tml::try_read() or tml::crawler::try_to(), is to be used.
+this_cxxflags += -fno-exceptions
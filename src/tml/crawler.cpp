@@ -29,29 +29,56 @@ SOFTWARE.
 using namespace tml;
 
 crawler crawler::in()
+{
+	auto ret = this->try_in();
+	if (!ret.has_value()) {
+		internal::throw_exception(std::logic_error("crawler::in() failed, node has no children"));
+	}
+	return ret.value();
+}
+
+std::optional<crawler> crawler::try_in() noexcept
 {
 	ASSERT(this->i != this->b.end())
 	if (this->get().children.size() == 0) {
-		throw std::logic_error("crawler::in() failed, node has no children");
+		return {};
 	}
-	return {this->get().children};
+	return crawler(this->get().children);
 }
 
 crawler& crawler::next()
 {
-	ASSERT(this->i != this->b.end())
-	++this->i;
-	if (this->i == this->b.end()) {
-		throw std::logic_error("crawler::next() failed, reached end of node list");
+	if (!this->try_next()) {
+		internal::throw_exception(std::logic_error("crawler::next() failed, reached end of node list"));
 	}
 	return *this;
 }
 
+bool crawler::try_next() noexcept
+{
+	ASSERT(this->i != this->b.end())
+	auto n = std::next(this->i);
+	if (n == this->b.end()) {
+		return false;
+	}
+	this->i = n;
+	return true;
+}
+
 crawler& crawler::to(const std::string& str)
 {
-	this->i = std::find(this->i, this->b.end(), str);
-	if (this->i != this->b.end()) {
+	if (this->try_to(str)) {
 		return *this;
 	}
-	throw std::runtime_error("crawler::to() failed, reached end of node list");
+	internal::throw_exception(std::runtime_error("crawler::to() failed, reached end of node list"));
+}
+
+bool crawler::try_to(std::string_view str) noexcept
+{
+	auto found = std::find(this->i, this->b.end(), str);
+	if (found == this->b.end()) {
+		return false;
+	}
+	this->i = found;
+	return true;
 }
@@ -26,6 +26,10 @@ SOFTWARE.
 
 #pragma once
 
+#include <optional>
+#include <string_view>
+
+#include "exception.hpp"
 #include "tree.hpp"
 
 namespace tml {
@@ -41,7 +45,7 @@ public:
 		i(b.begin())
 	{
 		if (b.size() == 0) {
-			throw std::logic_error("crawler::crawler() failed, reached end of node list");
+			internal::throw_exception(std::logic_error("crawler::crawler() failed, reached end of node list"));
 		}
 	}
 
@@ -64,6 +68,21 @@ public:
 
 	crawler& to(const std::string& str);
 
+	/**
+	 * @brief Move to the node with the given value, non-throwing version of to().
+	 * The search starts from the current node.
+	 * @param str - the value of the node to move to.
+	 * @return true in case the node is found, the crawler points to the found node.
+	 * @return false in case the node is not found, the crawler remains pointing to the current node.
+	 */
+	bool try_to(std::string_view str) noexcept;
+
+	bool try_to(std::string_view str) const noexcept
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+		return const_cast<crawler*>(this)->try_to(str);
+	}
+
 	const crawler& to(const std::string& str) const
 	{
 		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
@@ -73,11 +92,10 @@ public:
 	template <class predicate_type>
 	crawler& to_if(predicate_type p)
 	{
-		this->i = std::find_if(this->i, this->b.end(), p);
-		if (this->i != this->b.end()) {
+		if (this->try_to_if(p)) {
 			return *this;
 		}
-		throw std::runtime_error("crawler::to_if() failed, reached end of node list");
+		internal::throw_exception(std::runtime_error("crawler::to_if() failed, reached end of node list"));
 	}
 
 	template <class predicate_type>
@@ -87,6 +105,31 @@ public:
 		return const_cast<crawler*>(this)->to_if(p);
 	}
 
+	/**
+	 * @brief Move to the node satisfying the predicate, non-throwing version of to_if().
+	 * The search starts from the current node.
+	 * @param p - the predicate.
+	 * @return true in case the node is found, the crawler points to the found node.
+	 * @return false in case the node is not found, the crawler remains pointing to the current node.
+	 */
+	template <class predicate_type>
+	bool try_to_if(predicate_type p)
+	{
+		auto found = std::find_if(this->i, this->b.end(), p);
+		if (found == this->b.end()) {
+			return false;
+		}
+		this->i = found;
+		return true;
+	}
+
+	template <class predicate_type>
+	bool try_to_if(predicate_type p) const
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+		return const_cast<crawler*>(this)->try_to_if(p);
+	}
+
 	crawler& next();
 
 	const crawler& next() const
@@ -95,6 +138,19 @@ public:
 		return const_cast<crawler*>(this)->next();
 	}
 
+	/**
+	 * @brief Move to the next node, non-throwing version of next().
+	 * @return true in case there is a next node, the crawler points to it.
+	 * @return false in case the current node is the last one, the crawler remains pointing to the current node.
+	 */
+	bool try_next() noexcept;
+
+	bool try_next() const noexcept
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+		return const_cast<crawler*>(this)->try_next();
+	}
+
 	crawler in();
 
 	const crawler in() const
@@ -102,6 +158,19 @@ public:
 		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
 		return const_cast<crawler*>(this)->in();
 	}
+
+	/**
+	 * @brief Get crawler of the current node's children, non-throwing version of in().
+	 * @return Crawler pointing to the first child of the current node.
+	 * @return Nothing in case the current node has no children.
+	 */
+	std::optional<crawler> try_in() noexcept;
+
+	std::optional<const crawler> try_in() const noexcept
+	{
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+		return const_cast<crawler*>(this)->try_in();
+	}
 };
 
 using const_crawler = const crawler;
@@ -0,0 +1,134 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include "extra_info.hpp"
+
+namespace tml {
+
+/**
+ * @brief Kind of a problem found in malformed tml document.
+ */
+enum class diagnostic_kind {
+	/**
+	 * @brief Opening curly brace which is not preceded by a string.
+	 * Parser recovers by assuming an empty string before the curly brace.
+	 */
+	unexpected_opening_curly_brace,
+
+	/**
+	 * @brief Closing curly brace without matching opening one.
+	 * Parser recovers by ignoring the curly brace.
+	 */
+	unexpected_closing_curly_brace,
+
+	/**
+	 * @brief Digits of \u or \U escape sequence are not a hexadecimal number.
+	 * Parser recovers by dropping the escape sequence.
+	 */
+	invalid_unicode_escape_sequence,
+
+	/**
+	 * @brief Document ends in the middle of a quoted or raw string.
+	 * Parser recovers by terminating the string at the end of the document.
+	 */
+	unterminated_string,
+
+	/**
+	 * @brief Document ends in the middle of a multiline comment.
+	 * Parser recovers by terminating the comment at the end of the document.
+	 */
+	unterminated_comment,
+
+	/**
+	 * @brief Document ends in the middle of a children list.
+	 * Parser recovers by closing the children list at the end of the document.
+	 * This diagnostic is reported for each unclosed children list.
+	 */
+	unclosed_children_list,
+
+	enum_size
+};
+
+/**
+ * @brief Description of a problem found in malformed tml document.
+ */
+struct diagnostic {
+	diagnostic_kind kind;
+
+	/**
+	 * @brief Location of the problem.
+	 * For the problems detected at the end of the document it is the location of the document end.
+	 */
+	tml::location location;
+};
+
+/**
+ * @brief Receiver of diagnostics.
+ * In case the diagnostics sink is set to the parser, the parser does not throw on malformed document,
+ * but reports the problem to the diagnostics sink, recovers and continues parsing.
+ */
+class diagnostics_sink
+{
+public:
+	diagnostics_sink() = default;
+
+	diagnostics_sink(const diagnostics_sink&) = default;
+	diagnostics_sink& operator=(const diagnostics_sink&) = default;
+
+	diagnostics_sink(diagnostics_sink&&) = default;
+	diagnostics_sink& operator=(diagnostics_sink&&) = default;
+
+	virtual ~diagnostics_sink() = default;
+
+	/**
+	 * @brief Report a problem.
+	 * @param d - the problem description.
+	 */
+	virtual void report(const diagnostic& d) = 0;
+};
+
+namespace internal {
+
+/**
+ * @brief Diagnostics sink which only records whether any problem has been reported.
+ */
+class error_flag_sink : public diagnostics_sink
+{
+public:
+	bool error = false;
+
+	void report(const diagnostic&) override
+	{
+		this->error = true;
+	}
+};
+
+} // namespace internal
+
+} // namespace tml
@@ -0,0 +1,183 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#include "document.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "parser.hpp"
+
+using namespace tml;
+
+char* internal::arena::allocate_block(size_t size)
+{
+	// the memory is not value-initialized, as it would be with std::make_unique()
+	// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, cppcoreguidelines-owning-memory)
+	this->blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+	return this->blocks.back().get();
+}
+
+void* internal::arena::allocate(size_t size, size_t alignment)
+{
+	ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0)
+
+	auto padding = [alignment](const char* p) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		return (alignment - (reinterpret_cast<uintptr_t>(p) & (alignment - 1))) & (alignment - 1);
+	};
+
+	if (this->num_free_bytes < padding(this->cur) + size) {
+		size_t required_size = size + alignment - 1;
+
+		if (required_size > this->next_block_size) {
+			// allocate dedicated block for big allocation, and keep allocating from current block
+			auto block = this->allocate_block(required_size);
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			return block + padding(block);
+		}
+
+		this->cur = this->allocate_block(this->next_block_size);
+		this->num_free_bytes = this->next_block_size;
+		this->next_block_size = std::min(this->next_block_size * 2, max_block_size);
+	}
+
+	auto offset = padding(this->cur) + size;
+	ASSERT(offset <= this->num_free_bytes)
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto ret = this->cur + (offset - size);
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	this->cur += offset;
+	this->num_free_bytes -= offset;
+
+	return ret;
+}
+
+std::string_view internal::arena::make_string(std::string_view str)
+{
+	if (str.empty()) {
+		return {};
+	}
+
+	auto p = static_cast<char*>(this->allocate(str.size(), 1));
+	std::copy(str.begin(), str.end(), p);
+
+	return {p, str.size()};
+}
+
+namespace tml::internal {
+class document_builder
+{
+	document& doc;
+
+	// nodes of the currently open children lists, one list per nesting level,
+	// the vectors are reused to avoid memory allocations
+	std::vector<std::vector<document::node>> levels;
+	size_t depth = 0;
+
+public:
+	constexpr static bool needs_extra_info = false;
+
+	document_builder(document& doc) :
+		doc(doc),
+		levels(1)
+	{}
+
+	void on_children_parse_started(location)
+	{
+		++this->depth;
+		if (this->depth == this->levels.size()) {
+			this->levels.emplace_back();
+		}
+		ASSERT(this->levels[this->depth].empty())
+	}
+
+	void on_children_parse_finished(location)
+	{
+		ASSERT(this->depth != 0)
+
+		auto& children = this->levels[this->depth];
+		auto arr = this->doc.arena.make_array(utki::make_span(std::as_const(children)));
+		children.clear();
+
+		--this->depth;
+		this->levels[this->depth].back().children = arr;
+	}
+
+	void on_string_parsed(std::string_view str, const extra_info&)
+	{
+		this->levels[this->depth].push_back({this->doc.arena.make_string(str), {}});
+	}
+
+	void finish()
+	{
+		ASSERT(this->depth == 0)
+		this->doc.root_nodes = this->doc.arena.make_array(utki::make_span(std::as_const(this->levels.front())));
+	}
+};
+} // namespace tml::internal
+
+namespace {
+forest to_forest(utki::span<const document::node> nodes)
+{
+	forest ret;
+	ret.reserve(nodes.size());
+	for (const auto& n : nodes) {
+		ret.emplace_back(leaf(n.value), to_forest(n.children));
+	}
+	return ret;
+}
+} // namespace
+
+forest document::to_forest() const
+{
+	return ::to_forest(this->roots());
+}
+
+document tml::read_document(const fsif::file& fi)
+{
+	document doc;
+	internal::document_builder builder(doc);
+
+	tml::parse(fi, builder);
+
+	builder.finish();
+	return doc;
+}
+
+document tml::read_document(std::string_view str)
+{
+	document doc;
+	internal::document_builder builder(doc);
+
+	tml::parse(utki::make_span(str), builder);
+
+	builder.finish();
+	return doc;
+}
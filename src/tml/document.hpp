@@ -0,0 +1,184 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <fsif/file.hpp>
+#include <utki/span.hpp>
+
+#include "tree.hpp"
+
+namespace tml {
+
+namespace internal {
+
+/**
+ * @brief Monotonic memory arena.
+ * The memory is allocated from big blocks and is freed only all at once, when the arena is destroyed.
+ * So, only trivially destructible objects are supposed to be placed in the arena memory.
+ */
+class arena
+{
+	std::vector<std::unique_ptr<char[]>> blocks; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+
+	char* cur = nullptr;
+	size_t num_free_bytes = 0;
+
+	constexpr static size_t initial_block_size = 0x1000;
+	constexpr static size_t max_block_size = 0x100000;
+
+	size_t next_block_size = initial_block_size;
+
+	char* allocate_block(size_t size);
+
+public:
+	arena() = default;
+
+	arena(const arena&) = delete;
+	arena& operator=(const arena&) = delete;
+
+	arena(arena&&) = default;
+	arena& operator=(arena&&) = default;
+
+	~arena() = default;
+
+	/**
+	 * @brief Allocate memory.
+	 * @param size - size of the memory to allocate, in bytes.
+	 * @param alignment - alignment of the memory to allocate, must be a power of 2.
+	 * @return Pointer to the allocated memory.
+	 */
+	void* allocate(size_t size, size_t alignment);
+
+	/**
+	 * @brief Copy string to the arena memory.
+	 * @param str - string to copy.
+	 * @return The string copy residing in the arena memory.
+	 */
+	std::string_view make_string(std::string_view str);
+
+	/**
+	 * @brief Copy array of objects to the arena memory.
+	 * @param items - objects to copy.
+	 * @return The array copy residing in the arena memory.
+	 */
+	template <typename object_type>
+	utki::span<const object_type> make_array(utki::span<const object_type> items)
+	{
+		static_assert(
+			std::is_trivially_destructible_v<object_type>,
+			"only trivially destructible objects can be placed in the arena"
+		);
+
+		if (items.empty()) {
+			return {};
+		}
+
+		auto p = static_cast<object_type*>(this->allocate(items.size() * sizeof(object_type), alignof(object_type)));
+		std::uninitialized_copy(items.begin(), items.end(), p);
+
+		return utki::make_span(p, items.size());
+	}
+};
+
+class document_builder;
+
+} // namespace internal
+
+/**
+ * @brief Read-only tml document.
+ * All the nodes, the children arrays and the string bytes of the document are allocated
+ * from a single monotonic memory arena owned by the document object.
+ * So, reading the document requires only a handful of memory allocations and the document destruction
+ * only needs to free the arena memory blocks.
+ */
+class document
+{
+	friend class internal::document_builder;
+
+public:
+	/**
+	 * @brief Document node.
+	 * The node and its string value refer to the document's memory, so those are only valid
+	 * during the document object lifetime.
+	 */
+	struct node {
+		std::string_view value;
+		utki::span<const node> children;
+	};
+
+private:
+	internal::arena arena;
+
+	utki::span<const node> root_nodes;
+
+public:
+	document() = default;
+
+	document(const document&) = delete;
+	document& operator=(const document&) = delete;
+
+	document(document&&) = default;
+	document& operator=(document&&) = default;
+
+	~document() = default;
+
+	/**
+	 * @brief Get top level nodes of the document.
+	 * @return Top level nodes of the document.
+	 */
+	utki::span<const node> roots() const noexcept
+	{
+		return this->root_nodes;
+	}
+
+	/**
+	 * @brief Convert the document to tml::forest.
+	 * @return tml::forest containing copy of the document's nodes.
+	 */
+	forest to_forest() const;
+};
+
+/**
+ * @brief Read tml document.
+ * @param fi - file interface to read the document from.
+ * @return The read document.
+ */
+document read_document(const fsif::file& fi);
+
+/**
+ * @brief Read tml document.
+ * @param str - the tml document.
+ * @return The read document.
+ */
+document read_document(std::string_view str);
+
+} // namespace tml
@@ -0,0 +1,60 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#	define TML_EXCEPTIONS 1
+#else
+#	define TML_EXCEPTIONS 0
+#endif
+
+namespace tml::internal {
+
+/**
+ * @brief Report an error.
+ * In case the library is compiled with exceptions support, the exception is thrown.
+ * Otherwise, the error message is printed to stderr and the program is aborted.
+ * Compiling without exceptions support is done with -fno-exceptions compiler flag, see config/no_exceptions.mk.
+ * Non-throwing alternatives, like tml::try_read() or tml::crawler::try_to(), are to be used in such case.
+ * @param e - the exception to throw.
+ */
+template <typename exception_type>
+[[noreturn]] void throw_exception(const exception_type& e)
+{
+#if TML_EXCEPTIONS
+	throw e;
+#else
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+	std::fprintf(stderr, "tml: %s\n", e.what());
+	std::abort();
+#endif
+}
+
+} // namespace tml::internal
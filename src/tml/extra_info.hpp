@@ -83,11 +83,22 @@ enum class flag {
 struct location {
 	size_t line = 0;
 	size_t offset = 0;
+
+	/**
+	 * @brief Offset in bytes from the beginning of the document.
+	 */
+	size_t byte_offset = 0;
 };
 
 struct extra_info {
 	tml::location location;
 	utki::flags<tml::flag> flags;
+
+	/**
+	 * @brief Length of the token in the original document, in bytes.
+	 * The token includes its quotes and raw string delimiters, if any.
+	 */
+	size_t length = 0;
 };
 
 } // namespace tml
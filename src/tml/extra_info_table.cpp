@@ -0,0 +1,92 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "extra_info_table.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <utki/debug.hpp>
+
+using namespace tml;
+
+namespace {
+uint32_t saturate(size_t value) noexcept
+{
+	return uint32_t(std::min(value, size_t(std::numeric_limits<uint32_t>::max())));
+}
+} // namespace
+
+void extra_info_table::push_back(const extra_info& info)
+{
+	uint8_t flags = 0;
+	for (size_t i = 0; i != size_t(flag::enum_size); ++i) {
+		if (info.flags.get(flag(i))) {
+			flags |= uint8_t(1 << i);
+		}
+	}
+
+	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+	this->records.push_back({
+		uint64_t(info.location.byte_offset),
+		saturate(info.location.line),
+		saturate(info.location.offset),
+		saturate(info.length),
+		flags
+	});
+}
+
+location extra_info_table::get_location(size_t node_index) const noexcept
+{
+	ASSERT(node_index < this->records.size())
+	const auto& r = this->records[node_index];
+
+	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+	return {r.line, r.offset, size_t(r.byte_offset)};
+}
+
+utki::flags<flag> extra_info_table::get_flags(size_t node_index) const noexcept
+{
+	ASSERT(node_index < this->records.size())
+	const auto& r = this->records[node_index];
+
+	utki::flags<flag> ret;
+	for (size_t i = 0; i != size_t(flag::enum_size); ++i) {
+		ret.set(flag(i), (r.flags & (1 << i)) != 0);
+	}
+	return ret;
+}
+
+extra_info extra_info_table::operator[](size_t node_index) const noexcept
+{
+	ASSERT(node_index < this->records.size())
+
+	extra_info ret;
+	ret.location = this->get_location(node_index);
+	ret.flags = this->get_flags(node_index);
+	ret.length = this->records[node_index].length;
+	return ret;
+}
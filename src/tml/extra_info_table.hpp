@@ -0,0 +1,112 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "extra_info.hpp"
+
+namespace tml {
+
+/**
+ * @brief Compact array of extra info of tml nodes.
+ * Stores extra info of nodes of an ordinary tml::forest, so that the forest does not need to be
+ * a tml::forest_ext. The nodes are numbered in pre-order, i.e. in the order they appear in the document,
+ * and the table is indexed by the node number.
+ * The extra info is packed, the line, offset within the line and the token length are stored as 32-bit numbers,
+ * the flags are stored as bits. So, one record is considerably smaller than tml::extra_info.
+ * The values which do not fit into 32 bits are saturated to the maximum 32-bit value.
+ */
+class extra_info_table
+{
+	struct record {
+		uint64_t byte_offset;
+		uint32_t line;
+		uint32_t offset;
+		uint32_t length;
+		uint8_t flags;
+	};
+
+	static_assert(size_t(flag::enum_size) <= sizeof(record::flags) * 8, "flags do not fit into the record");
+
+	std::vector<record> records;
+
+public:
+	/**
+	 * @brief Get number of nodes in the table.
+	 * @return Number of nodes.
+	 */
+	size_t size() const noexcept
+	{
+		return this->records.size();
+	}
+
+	bool empty() const noexcept
+	{
+		return this->records.empty();
+	}
+
+	void clear() noexcept
+	{
+		this->records.clear();
+	}
+
+	void reserve(size_t num_nodes)
+	{
+		this->records.reserve(num_nodes);
+	}
+
+	/**
+	 * @brief Append extra info of the next node.
+	 * @param info - extra info of the node.
+	 */
+	void push_back(const extra_info& info);
+
+	/**
+	 * @brief Get extra info of the node.
+	 * @param node_index - pre-order number of the node.
+	 * @return Unpacked extra info of the node.
+	 */
+	extra_info operator[](size_t node_index) const noexcept;
+
+	/**
+	 * @brief Get location of the node.
+	 * @param node_index - pre-order number of the node.
+	 * @return Location of the node.
+	 */
+	location get_location(size_t node_index) const noexcept;
+
+	/**
+	 * @brief Get flags of the node.
+	 * @param node_index - pre-order number of the node.
+	 * @return Flags of the node.
+	 */
+	utki::flags<flag> get_flags(size_t node_index) const noexcept;
+};
+
+} // namespace tml
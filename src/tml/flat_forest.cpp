@@ -0,0 +1,125 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#include "flat_forest.hpp"
+
+#include "parser.hpp"
+
+using namespace tml;
+
+void flat_forest::append(const forest& f)
+{
+	for (const auto& t : f) {
+		auto index = this->records.size();
+		this->records.push_back({this->strings.size(), t.value.string.size(), 0});
+		this->strings.append(t.value.string);
+
+		this->append(t.children);
+
+		this->records[index].num_descendants = this->records.size() - index - 1;
+	}
+}
+
+flat_forest::flat_forest(const forest& f)
+{
+	this->append(f);
+}
+
+namespace {
+forest to_forest(flat_forest::range nodes)
+{
+	forest ret;
+	for (const auto n : nodes) {
+		ret.emplace_back(leaf(n.value()), to_forest(n.children()));
+	}
+	return ret;
+}
+} // namespace
+
+forest flat_forest::to_forest() const
+{
+	return ::to_forest(this->roots());
+}
+
+namespace tml::internal {
+class flat_forest_builder
+{
+	flat_forest& f;
+
+	// indices of the nodes whose children are being parsed
+	std::vector<size_t> stack;
+
+public:
+	constexpr static bool needs_extra_info = false;
+
+	flat_forest_builder(flat_forest& f) :
+		f(f)
+	{}
+
+	void on_children_parse_started(location)
+	{
+		ASSERT(!this->f.records.empty())
+		this->stack.push_back(this->f.records.size() - 1);
+	}
+
+	void on_children_parse_finished(location)
+	{
+		ASSERT(!this->stack.empty())
+
+		auto index = this->stack.back();
+		this->stack.pop_back();
+
+		this->f.records[index].num_descendants = this->f.records.size() - index - 1;
+	}
+
+	void on_string_parsed(std::string_view str, const extra_info&)
+	{
+		this->f.records.push_back({this->f.strings.size(), str.size(), 0});
+		this->f.strings.append(str);
+	}
+};
+} // namespace tml::internal
+
+flat_forest tml::read_flat(const fsif::file& fi)
+{
+	flat_forest ret;
+	internal::flat_forest_builder builder(ret);
+
+	tml::parse(fi, builder);
+
+	return ret;
+}
+
+flat_forest tml::read_flat(std::string_view str)
+{
+	flat_forest ret;
+	internal::flat_forest_builder builder(ret);
+
+	tml::parse(utki::make_span(str), builder);
+
+	return ret;
+}
@@ -0,0 +1,288 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fsif/file.hpp>
+#include <utki/span.hpp>
+
+#include "tree.hpp"
+
+namespace tml {
+
+namespace internal {
+class flat_forest_builder;
+} // namespace internal
+
+/**
+ * @brief Read-only forest stored in flat arrays.
+ * The nodes are stored in one contiguous array in pre-order, i.e. each node is followed by its
+ * descendants and then by its next sibling. Each node record holds the number of its descendants,
+ * so the first child of a node is the next record and the next sibling is the record which follows
+ * all the node's descendants. The string bytes of all the nodes are stored in a single string pool.
+ */
+class flat_forest
+{
+	friend class internal::flat_forest_builder;
+
+public:
+	/**
+	 * @brief Node record.
+	 */
+	struct record {
+		/**
+		 * @brief Offset of the node's string in the string pool.
+		 */
+		size_t string_offset;
+
+		/**
+		 * @brief Length of the node's string.
+		 */
+		size_t string_length;
+
+		/**
+		 * @brief Number of all descendants of the node.
+		 */
+		size_t num_descendants;
+	};
+
+private:
+	std::vector<record> records;
+	std::string strings;
+
+	void append(const forest& f);
+
+public:
+	class range;
+
+	/**
+	 * @brief Node of the flat forest.
+	 * The node object is a lightweight reference to the node record, so it is only valid as long as the
+	 * flat_forest object it refers to is alive.
+	 */
+	class node
+	{
+		friend class range;
+
+		const flat_forest* owner;
+		size_t index;
+
+		node(const flat_forest& owner, size_t index) :
+			owner(&owner),
+			index(index)
+		{}
+
+		const record& get_record() const noexcept
+		{
+			return this->owner->records[this->index];
+		}
+
+	public:
+		/**
+		 * @brief Get the node's string.
+		 * @return The node's string.
+		 */
+		std::string_view value() const noexcept
+		{
+			const auto& r = this->get_record();
+			return std::string_view(this->owner->strings).substr(r.string_offset, r.string_length);
+		}
+
+		/**
+		 * @brief Get the node's children.
+		 * @return Range of the node's children.
+		 */
+		range children() const noexcept
+		{
+			return {*this->owner, this->index + 1, this->index + 1 + this->get_record().num_descendants};
+		}
+
+		/**
+		 * @brief Get index of the node's record.
+		 * @return Index of the node's record in the records array.
+		 */
+		size_t get_index() const noexcept
+		{
+			return this->index;
+		}
+	};
+
+	/**
+	 * @brief Range of sibling nodes.
+	 */
+	class range
+	{
+		friend class flat_forest;
+		friend class node;
+
+		const flat_forest* owner;
+		size_t begin_index;
+		size_t end_index;
+
+		range(const flat_forest& owner, size_t begin_index, size_t end_index) :
+			owner(&owner),
+			begin_index(begin_index),
+			end_index(end_index)
+		{}
+
+	public:
+		class iterator
+		{
+			friend class range;
+
+			const flat_forest* owner;
+			size_t index;
+
+			iterator(const flat_forest& owner, size_t index) :
+				owner(&owner),
+				index(index)
+			{}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = node;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = node;
+
+			node operator*() const noexcept
+			{
+				return {*this->owner, this->index};
+			}
+
+			iterator& operator++() noexcept
+			{
+				this->index += 1 + this->owner->records[this->index].num_descendants;
+				return *this;
+			}
+
+			iterator operator++(int) noexcept
+			{
+				auto ret = *this;
+				++(*this);
+				return ret;
+			}
+
+			bool operator==(const iterator& i) const noexcept
+			{
+				return this->index == i.index;
+			}
+
+			bool operator!=(const iterator& i) const noexcept
+			{
+				return !this->operator==(i);
+			}
+		};
+
+		iterator begin() const noexcept
+		{
+			return {*this->owner, this->begin_index};
+		}
+
+		iterator end() const noexcept
+		{
+			return {*this->owner, this->end_index};
+		}
+
+		bool empty() const noexcept
+		{
+			return this->begin_index == this->end_index;
+		}
+
+		/**
+		 * @brief Get number of nodes in the range.
+		 * Complexity is linear in number of nodes in the range.
+		 * @return Number of nodes in the range.
+		 */
+		size_t size() const noexcept
+		{
+			return size_t(std::distance(this->begin(), this->end()));
+		}
+	};
+
+	flat_forest() = default;
+
+	/**
+	 * @brief Construct flat forest from tml::forest.
+	 * @param f - forest to copy.
+	 */
+	flat_forest(const forest& f);
+
+	/**
+	 * @brief Get top level nodes.
+	 * @return Range of top level nodes.
+	 */
+	range roots() const noexcept
+	{
+		return {*this, 0, this->records.size()};
+	}
+
+	/**
+	 * @brief Get node records.
+	 * @return All node records in pre-order.
+	 */
+	utki::span<const record> get_records() const noexcept
+	{
+		return utki::make_span(this->records);
+	}
+
+	/**
+	 * @brief Get string pool.
+	 * @return String pool containing strings of all nodes.
+	 */
+	std::string_view get_strings() const noexcept
+	{
+		return this->strings;
+	}
+
+	/**
+	 * @brief Convert to tml::forest.
+	 * @return tml::forest containing copy of the nodes.
+	 */
+	forest to_forest() const;
+};
+
+/**
+ * @brief Read tml document to flat forest.
+ * @param fi - file interface to read the document from.
+ * @return The read flat forest.
+ */
+flat_forest read_flat(const fsif::file& fi);
+
+/**
+ * @brief Read tml document to flat forest.
+ * @param str - the tml document.
+ * @return The read flat forest.
+ */
+flat_forest read_flat(std::string_view str);
+
+} // namespace tml
@@ -0,0 +1,68 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <stack>
+
+#include <utki/debug.hpp>
+
+#include "extra_info.hpp"
+
+namespace tml::internal {
+
+/**
+ * @brief Base of the listeners which build a tree of nodes from the parsed document.
+ * The listeners are not derived from tml::listener, so that the parser calls their methods directly.
+ * The derived listener appends the parsed strings to the cur_forest.
+ * @tparam forest_type - type of the node list, e.g. tml::forest or tml::forest_ext.
+ */
+template <typename forest_type>
+class forest_builder
+{
+	// node lists enclosing the children list being parsed
+	std::stack<forest_type> stack;
+
+public:
+	forest_type cur_forest;
+
+	void on_children_parse_started(location)
+	{
+		this->stack.push(std::move(this->cur_forest));
+		utki::assert(this->cur_forest.size() == 0, SL);
+	}
+
+	void on_children_parse_finished(location)
+	{
+		// the parser does not notify about unopened curly braces
+		ASSERT(!this->stack.empty())
+		this->stack.top().back().children = std::move(this->cur_forest);
+		this->cur_forest = std::move(this->stack.top());
+		this->stack.pop();
+	}
+};
+
+} // namespace tml::internal
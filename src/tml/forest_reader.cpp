@@ -0,0 +1,114 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "forest_reader.hpp"
+
+using namespace tml;
+
+forest forest_reader::builder::take_forest()
+{
+	if (this->free_forests.empty()) {
+		return {};
+	}
+	forest ret = std::move(this->free_forests.back());
+	this->free_forests.pop_back();
+	ASSERT(ret.empty())
+	return ret;
+}
+
+void forest_reader::builder::recycle(forest& wood)
+{
+	for (auto& t : wood) {
+		this->recycle(t.children);
+
+		auto& str = t.value.string;
+		if (str.capacity() > std::string().capacity()) {
+			// the string has heap allocated memory
+			str.clear();
+			this->free_strings.push_back(std::move(str));
+		}
+	}
+	wood.clear();
+
+	if (wood.capacity() != 0) {
+		this->free_forests.push_back(std::move(wood));
+	}
+}
+
+void forest_reader::builder::reset()
+{
+	for (auto& f : this->stack) {
+		this->recycle(f);
+	}
+	this->stack.clear();
+	this->recycle(this->cur_forest);
+}
+
+void forest_reader::builder::on_children_parse_started(location)
+{
+	this->stack.push_back(std::move(this->cur_forest));
+	this->cur_forest = this->take_forest();
+}
+
+void forest_reader::builder::on_children_parse_finished(location)
+{
+	ASSERT(!this->stack.empty())
+	this->stack.back().back().children = std::move(this->cur_forest);
+	this->cur_forest = std::move(this->stack.back());
+	this->stack.pop_back();
+}
+
+void forest_reader::builder::on_string_parsed(std::string_view str, const extra_info&)
+{
+	if (this->free_strings.empty()) {
+		this->cur_forest.emplace_back(str);
+		return;
+	}
+
+	std::string s = std::move(this->free_strings.back());
+	this->free_strings.pop_back();
+	s.assign(str);
+	this->cur_forest.emplace_back(std::move(s));
+}
+
+forest forest_reader::read(std::string_view str)
+{
+	// in case the previous reading has failed, discard its state
+	this->parser.reset();
+	this->forest_builder.reset();
+
+	this->forest_builder.cur_forest = this->forest_builder.take_forest();
+
+	this->parser.parse_data_chunk(utki::make_span(str), this->forest_builder);
+	this->parser.end_of_data(this->forest_builder);
+
+	return std::move(this->forest_builder.cur_forest);
+}
+
+void forest_reader::recycle(forest&& wood)
+{
+	this->forest_builder.recycle(wood);
+}
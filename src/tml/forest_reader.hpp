@@ -0,0 +1,99 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.hpp"
+#include "tree.hpp"
+
+namespace tml {
+
+/**
+ * @brief Reusable tml document reader.
+ * Reads tml documents the same way as tml::read() does, but keeps the parser buffers and the tree building state
+ * between the reads. In addition to that, the forests which are not needed anymore can be given back
+ * to the reader with recycle(), then the node lists and strings memory of those is reused by subsequent reads.
+ * So, in case documents of similar shapes are read repeatedly and recycled after use, the reading
+ * performs almost no memory allocations in the steady state.
+ * The reader is not thread-safe, it is supposed to be used one per thread.
+ */
+class forest_reader
+{
+	// builds the forest out of the parser events, using the recycled storage
+	class builder
+	{
+		friend class forest_reader;
+
+		std::vector<forest> stack;
+
+		// recycled node lists, cleared, but with the memory capacity retained
+		std::vector<forest> free_forests;
+
+		// recycled strings, cleared, but with the memory capacity retained
+		std::vector<std::string> free_strings;
+
+		forest cur_forest;
+
+		forest take_forest();
+		void recycle(forest& wood);
+
+		// discards the state left after failed reading
+		void reset();
+
+	public:
+		constexpr static bool needs_extra_info = false;
+
+		void on_children_parse_started(location loc);
+		void on_children_parse_finished(location loc);
+		void on_string_parsed(std::string_view str, const extra_info& info);
+	};
+
+	builder forest_builder;
+	basic_parser<builder> parser;
+
+public:
+	/**
+	 * @brief Read tml document.
+	 * @param str - the tml document.
+	 * @return Parsed tml forest.
+	 * @throw std::invalid_argument - in case the document is malformed.
+	 */
+	forest read(std::string_view str);
+
+	/**
+	 * @brief Give a forest back to the reader for reuse of its memory.
+	 * The node lists and strings of the forest are kept by the reader and reused by subsequent reads.
+	 * The forest need not come from this reader.
+	 * @param wood - the forest which is not needed anymore.
+	 */
+	void recycle(forest&& wood);
+};
+
+} // namespace tml
@@ -0,0 +1,64 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#include "line_index.hpp"
+
+#include <algorithm>
+
+#include "parser.hpp"
+
+using namespace tml;
+
+line_index::line_index(utki::span<const char> data) :
+	line_starts{0}
+{
+	for (size_t pos = 0;;) {
+		pos += internal::find_any_of<'\n'>(data.subspan(pos));
+		if (pos == data.size()) {
+			break;
+		}
+		++pos;
+		this->line_starts.push_back(pos);
+	}
+}
+
+location line_index::get_location(size_t byte_offset) const noexcept
+{
+	// the new line character is at offset 0 of the line it starts, so search for the next position
+	auto next_pos = byte_offset + 1;
+
+	auto i = std::upper_bound(this->line_starts.begin(), this->line_starts.end(), next_pos);
+	ASSERT(i != this->line_starts.begin())
+	--i;
+
+	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+	return {
+		size_t(std::distance(this->line_starts.begin(), i)) + 1, // line numbers start with 1
+		next_pos - *i,
+		byte_offset
+	};
+}
@@ -0,0 +1,76 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <vector>
+
+#include <utki/span.hpp>
+
+#include "extra_info.hpp"
+
+namespace tml {
+
+/**
+ * @brief Index of line beginnings of a tml document.
+ * Parser reports node locations as byte offsets along with line numbers and offsets within the line.
+ * In case only byte offsets of some positions are known, e.g. stored ones, the line index allows converting
+ * those to line numbers and offsets within the line without parsing the document again.
+ * The document is scanned for new line characters once, when the index is built.
+ */
+class line_index
+{
+	// byte offsets of line beginnings, first line begins at 0
+	std::vector<size_t> line_starts;
+
+public:
+	/**
+	 * @brief Build line index of the document.
+	 * @param data - the document.
+	 */
+	line_index(utki::span<const char> data);
+
+	/**
+	 * @brief Get number of lines in the document.
+	 * @return Number of lines, it is always at least 1.
+	 */
+	size_t num_lines() const noexcept
+	{
+		return this->line_starts.size();
+	}
+
+	/**
+	 * @brief Get location of the given position in the document.
+	 * Same way as in the locations reported by parser, the new line character is considered to be
+	 * at offset 0 of the line it starts.
+	 * @param byte_offset - offset of the position in bytes from the beginning of the document.
+	 * @return Location of the position, with 1-based line number and 1-based offset within the line.
+	 */
+	location get_location(size_t byte_offset) const noexcept;
+};
+
+} // namespace tml
@@ -26,703 +26,274 @@ SOFTWARE.
 
 #include "parser.hpp"
 
-#include <charconv>
-#include <cstring>
-#include <sstream>
-
-#include <utki/debug.hpp>
-#include <utki/string.hpp>
-#include <utki/unicode.hpp>
-
-#ifdef DEBUG
-#	include <utki/string.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	define TML_HAVE_MMAP 1
+#else
+#	define TML_HAVE_MMAP 0
 #endif
 
 using namespace tml;
 
-namespace {
-constexpr size_t file_read_chunk_size = 0x4ff;
-} // namespace
-
-void parser::next_line()
-{
-	++this->cur_loc.line;
-	this->cur_loc.offset = 0;
-}
+template class tml::basic_parser<tml::listener>;
 
-void parser::handle_string_parsed(listener& listener)
+namespace {
+// The whole document is skipped during validation, so the listener is never notified.
+class validation_listener
 {
-	auto span = utki::make_span(this->buf);
-
-	if (this->string_parsed_info.flags.get(flag::raw)) {
-		if (span.size() >= 2 && span[0] == '\r' && span[1] == '\n') {
-			span = span.subspan(2);
-		} else if (span.size() >= 1 && span[0] == '\n') {
-			span = span.subspan(1);
-		}
+public:
+	constexpr static bool needs_extra_info = false;
 
-		if (span.size() >= 1 && span.back() == '\n') {
-			span = span.subspan(0, span.size() - 1);
-		}
+	void on_children_parse_started(location) {}
 
-		if (span.size() >= 1 && span.back() == '\r') {
-			span = span.subspan(0, span.size() - 1);
-		}
-	}
+	void on_children_parse_finished(location) {}
 
-	listener.on_string_parsed(utki::make_string_view(span), this->string_parsed_info);
-	this->buf.clear();
-}
+	void on_string_parsed(std::string_view, const extra_info&) {}
+};
+} // namespace
 
-void parser::set_string_start_pos()
+bool tml::validate(utki::span<const char> data)
 {
-	this->info.location = this->cur_loc;
-}
+	validation_listener listener;
+	internal::error_flag_sink diagnostics;
 
-void parser::process_char_in_initial(char c, listener& listener)
-{
-	ASSERT(this->cur_state == state::initial)
-	switch (c) {
-		case '\n':
-			this->info.flags.set(tml::flag::first_on_line);
-		case ' ':
-		case '\t':
-		case '\r':
-			break;
-		case '/':
-			this->set_string_start_pos();
-			this->previous_state = state::initial;
-			this->cur_state = state::comment_seqence;
-			break;
-		case '\0':
-			this->cur_state = state::idle; // parser should remain in idle state after data end
-			break;
-		default:
-			this->process_char_in_idle(c, listener);
-			break;
-	}
-}
+	basic_parser<validation_listener> parser;
+	parser.set_diagnostics_sink(&diagnostics);
 
-void parser::process_char_in_idle(char c, listener& listener)
-{
-	switch (c) {
-		case '\n':
-			this->info.flags.set(tml::flag::first_on_line);
-		case ' ':
-		case '\t':
-		case '\r':
-			this->info.flags.set(tml::flag::space);
-			break;
-		case '\0':
-			break;
-		case '{':
-			ASSERT(this->buf.empty())
-			{
-				std::stringstream ss;
-				ss << "Malformed tml document fed. Unexpected { at line: " << this->cur_loc.line;
-				throw std::invalid_argument(ss.str());
-			}
-			break;
-		case '}':
-			listener.on_children_parse_finished(this->cur_loc);
-			--this->nesting_level;
-
-			// Some other states forward processing to 'process_char_in_idle()' by explicitly calling it,
-			// thus this function can be called even when parser is not in idle state.
-			// This is why here we set the state to idle.
-			this->cur_state = state::idle;
-
-			this->info.flags.clear(flag::space);
-			break;
-		case '"':
-			this->set_string_start_pos();
-			this->cur_state = state::raw_quotes_string_opening_sequence;
-			this->sequence_index = 1;
-			break;
-		case '/':
-			this->set_string_start_pos();
-			this->previous_state = state::idle;
-			this->cur_state = state::comment_seqence;
-			break;
-		case '\\':
-			this->set_string_start_pos();
-			this->previous_state = state::unquoted_string;
-			this->cur_state = state::escape_sequence;
-			break;
-		default:
-			this->buf.push_back(c);
-			this->set_string_start_pos();
-			this->cur_state = state::unquoted_string;
-			break;
-	}
-}
+	// skip the whole document, i.e. do not buffer strings and do not notify the listener
+	parser.skip_depth = 1;
 
-void parser::set_string_parsed_state()
-{
-	this->string_parsed_info = this->info;
-	this->info.flags.clear();
-	this->cur_state = state::string_parsed;
-}
+	// the whole document is in the data, so the parser can keep referring to it instead of copying,
+	// e.g. the long C++ style raw string delimiters
+	parser.parse_data_chunk_in_place(data, listener);
+	parser.end_of_data(listener);
 
-void parser::process_char_in_string_parsed(char c, listener& listener)
-{
-	ASSERT(this->cur_state == state::string_parsed)
-	switch (c) {
-		case '\n':
-			this->info.flags.set(tml::flag::first_on_line);
-		case ' ':
-		case '\r':
-		case '\t':
-			this->info.flags.set(tml::flag::space);
-			break;
-		case '/':
-			this->set_string_start_pos();
-			this->previous_state = state::string_parsed;
-			this->cur_state = state::comment_seqence;
-			break;
-		case '{':
-			this->string_parsed_info.flags.set(tml::flag::curly_braces);
-			this->handle_string_parsed(listener);
-			listener.on_children_parse_started(this->cur_loc);
-			this->cur_state = state::initial;
-			++this->nesting_level;
-			this->info.flags.clear(tml::flag::space);
-			this->info.flags.clear(tml::flag::first_on_line);
-			break;
-		default:
-			this->handle_string_parsed(listener);
-			this->cur_state = state::idle;
-			this->process_char_in_idle(c, listener);
-			break;
-	}
+	return !diagnostics.error;
 }
 
-void parser::process_char_in_unquoted_string(char c, listener& listener)
+internal::file_mapping::file_mapping(const std::string& path)
 {
-	ASSERT(this->cur_state == state::unquoted_string)
-	switch (c) {
-		case '"':
-			ASSERT(this->buf.size() != 0)
-			if (this->buf.size() == 1 && this->buf.back() == 'R') {
-				this->buf.clear();
-				this->cur_state = state::raw_cpp_string_opening_sequence;
-			} else {
-				this->set_string_parsed_state();
-				this->handle_string_parsed(listener);
-				this->cur_state = state::raw_quotes_string_opening_sequence;
-				this->sequence_index = 1;
-				this->set_string_start_pos();
-			}
-			break;
-		case '\n':
-		case ' ':
-		case '\r':
-		case '\t':
-			ASSERT(this->buf.size() != 0)
-			// this->handle_string_parsed(listener);
-			this->set_string_parsed_state();
-
-			this->info.flags.set(tml::flag::space);
-			if (c == '\n') {
-				this->info.flags.set(tml::flag::first_on_line);
-			}
-			break;
-		case '\0': // end of data
-			ASSERT(this->buf.size() != 0)
-			this->set_string_parsed_state();
-			this->handle_string_parsed(listener);
-			this->cur_state = state::idle;
-			break;
-		case '\\':
-			this->previous_state = this->cur_state;
-			this->cur_state = state::escape_sequence;
-			break;
-		case '{':
-			ASSERT(this->buf.size() != 0)
-			this->info.flags.set(tml::flag::curly_braces);
-			this->set_string_parsed_state();
-			this->handle_string_parsed(listener);
-			this->cur_state = state::initial;
-			listener.on_children_parse_started(this->cur_loc);
-			++this->nesting_level;
-			break;
-		case '}':
-			ASSERT(this->buf.size() != 0)
-			this->set_string_parsed_state();
-			this->handle_string_parsed(listener);
-			this->cur_state = state::idle;
-			listener.on_children_parse_finished(this->cur_loc);
-			--this->nesting_level;
-			break;
-		default:
-			this->buf.push_back(c);
-			break;
+#if TML_HAVE_MMAP
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+	this->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (this->fd < 0) {
+		return;
 	}
-}
 
-void parser::process_char_in_quoted_string(char c, listener&)
-{
-	ASSERT(this->cur_state == state::quoted_string)
-	switch (c) {
-		case '"':
-			this->set_string_parsed_state();
-			break;
-		case '\\':
-			this->previous_state = this->cur_state;
-			this->cur_state = state::escape_sequence;
-			break;
-		case '\n':
-		case '\r':
-		case '\t':
-			break;
-		default:
-			this->buf.push_back(c);
-			break;
+	struct stat st {};
+	if (fstat(this->fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+		return;
 	}
-}
 
-void parser::process_char_in_escape_sequence(char c, listener& listener)
-{
-	constexpr auto short_unicode_sequence_length = 4;
-	constexpr auto long_unicode_sequence_length = 8;
-
-	utki::assert(this->cur_state == state::escape_sequence, SL);
-	switch (c) {
-		case 'u':
-			this->cur_state = state::unicode_sequence;
-			this->sequence_index = 0;
-			this->sequence.resize(short_unicode_sequence_length);
-			return;
-		case 'U':
-			this->cur_state = state::unicode_sequence;
-			this->sequence_index = 0;
-			this->sequence.resize(long_unicode_sequence_length);
-			return;
-		case 'n':
-			this->buf.push_back('\n');
-			break;
-		case 't':
-			this->buf.push_back('\t');
-			break;
-		case '\n':
-			this->buf.push_back('\\');
-			if (this->previous_state == state::unquoted_string) {
-				this->cur_state = state::unquoted_string;
-				this->process_char_in_unquoted_string('\n', listener);
-				return;
-			}
-			break;
-		case '"':
-		case '\\':
-			this->buf.push_back(c);
-			break;
-		case ' ':
-		case '{':
-		case '}':
-			if (this->previous_state == state::quoted_string) {
-				this->buf.push_back('\\');
-			}
-			this->buf.push_back(c);
-			break;
-		default:
-			this->buf.push_back('\\');
-			this->buf.push_back(c);
-			break;
+	void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, this->fd, 0);
+	if (p == MAP_FAILED) {
+		return;
 	}
-	this->cur_state = this->previous_state;
-}
-
-void parser::process_char_in_unicode_sequence(char c, listener& listener)
-{
-	ASSERT(this->cur_state == state::unicode_sequence)
-
-	this->sequence[this->sequence_index] = c;
-	++this->sequence_index;
-
-	if (this->sequence_index == this->sequence.size()) {
-		uint32_t value = 0;
-		auto span = utki::make_span(this->sequence);
-		auto res = std::from_chars(
-			span.data(), //
-			utki::end_pointer(span),
-			value,
-			utki::to_int(utki::integer_base::hex)
-		);
-
-		if (res.ec == std::errc::invalid_argument) {
-			std::stringstream ss;
-			ss << "malformed document: could not parse hexadecimal number of unicode escape sequence at line: "
-			   << this->cur_loc.line;
-			throw std::invalid_argument(ss.str());
-		}
-
-		auto bytes = utki::to_utf8(char32_t(value));
 
-		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-		for (auto b : bytes) {
-			if (b == '\0') {
-				break;
-			}
-			this->buf.push_back(b);
-		}
+	this->ptr = p;
+	this->size = size_t(st.st_size);
 
-		this->cur_state = this->previous_state;
-		this->sequence.clear();
-	}
+	// the data is going to be parsed from beginning to end, so ask the kernel for aggressive read-ahead
+	posix_madvise(this->ptr, this->size, POSIX_MADV_SEQUENTIAL);
+#endif
 }
 
-void parser::process_char_in_comment_sequence(char c, listener& listener)
+internal::file_mapping::~file_mapping()
 {
-	ASSERT(this->cur_state == state::comment_seqence)
-	switch (c) {
-		case '/':
-			this->cur_state = state::single_line_comment;
-			break;
-		case '*':
-			this->cur_state = state::multiline_comment;
-			break;
-		case '{':
-			this->handle_string_parsed(listener);
-			ASSERT(this->buf.empty(), [this](auto& o) {
-				o << "this->buf = " << utki::make_string(this->buf);
-			})
-			this->set_string_start_pos();
-			--this->info.location.offset;
-
-			this->buf.push_back('/');
-			this->set_string_parsed_state();
-			this->handle_string_parsed(listener);
-			listener.on_children_parse_started(this->cur_loc);
-			++this->nesting_level;
-			this->cur_state = state::initial;
-			break;
-		case '\n':
-		case '\r':
-		case '\t':
-		case ' ':
-			if (!this->buf.empty()) {
-				this->handle_string_parsed(listener);
-			}
-			ASSERT(this->buf.empty(), [this](auto& o) {
-				o << "this->buf = " << utki::make_string(this->buf);
-			})
-			this->buf.push_back('/');
-			// this->handle_string_parsed(listener);
-			this->set_string_parsed_state();
-			break;
-		default:
-			if (!this->buf.empty()) {
-				this->handle_string_parsed(listener);
-			}
-			ASSERT(this->buf.empty())
-			this->buf.push_back('/');
-			this->buf.push_back(c);
-			this->cur_state = state::unquoted_string;
-			break;
+#if TML_HAVE_MMAP
+	if (this->ptr) {
+		munmap(this->ptr, this->size);
+	}
+	if (this->fd >= 0) {
+		close(this->fd);
 	}
+#endif
 }
 
-void parser::process_char_in_single_line_comment(char c, listener& listener)
+void tml::parse(
+	const fsif::file& fi, //
+	listener& listener,
+	size_t chunk_size
+)
 {
-	ASSERT(this->cur_state == state::single_line_comment)
-	this->info.flags.set(tml::flag::space);
-	switch (c) {
-		case '\0':
-			this->cur_state = this->previous_state;
-			this->process_char('\0', listener);
-			break;
-		case '\n':
-			this->cur_state = this->previous_state;
-			break;
-		default:
-			break;
-	}
+	internal::parse(fi, listener, chunk_size);
 }
 
-void parser::process_char_in_multiline_comment(char c, listener& listener)
+void tml::parse(utki::span<const char> data, listener& listener)
 {
-	ASSERT(this->cur_state == state::multiline_comment)
-	switch (c) {
-		case '*':
-			ASSERT(this->sequence.empty())
-			// ASSERT(this->buf.size() == 0)
-			this->sequence.push_back('*');
-			break;
-		case '/':
-			if (this->sequence.size() != 0) {
-				ASSERT(this->sequence.size() == 1)
-				ASSERT(this->sequence.back() == '*')
-				this->sequence.clear();
-				this->cur_state = this->previous_state;
-			}
-			break;
-		default:
-			this->sequence.clear();
-			break;
-	}
+	internal::parse(data, listener);
 }
 
-void parser::process_char_in_raw_cpp_string_opening_sequence(char c, listener& listener)
+void tml::parse_mapped(const std::string& path, listener& listener)
 {
-	ASSERT(this->cur_state == state::raw_cpp_string_opening_sequence)
-	switch (c) {
-		case '"':
-			// not a C++ style raw string, report 'R' string and a quoted string
-			{
-				char r = 'R';
-				listener.on_string_parsed(std::string_view(&r, 1), this->info);
-				this->info.flags.clear(tml::flag::space);
-			}
-			++this->info.location.offset;
-
-			if (this->buf.empty()) {
-				this->cur_state = state::raw_quotes_string_opening_sequence;
-				this->sequence_index = 2; // it is a second double quote in a row
-			} else {
-				this->info.flags.set(tml::flag::quoted);
-				// this->handle_string_parsed(listener);
-				this->set_string_parsed_state();
-			}
-			break;
-		case '(':
-			this->sequence.assign(this->buf.data(), this->buf.size());
-			this->buf.clear();
-			this->cur_state = state::raw_cpp_string;
-			this->info.flags.set(flag::raw);
-			break;
-		default:
-			this->buf.push_back(c);
-			break;
-	}
+	internal::parse_mapped(path, listener);
 }
 
-void parser::process_char_in_raw_cpp_string(char c, listener& listener)
+namespace {
+constexpr std::string_view snapshot_signature = "tmls";
+constexpr uint64_t snapshot_format_version = 1;
+
+constexpr unsigned bits_in_byte = 8;
+
+// The numbers are written as 64-bit little-endian.
+class snapshot_writer
 {
-	ASSERT(this->cur_state == state::raw_cpp_string)
-	switch (c) {
-		case ')':
-			this->sequence_index = 0;
-			this->cur_state = state::raw_cpp_string_closing_sequence;
-			break;
-		default:
-			this->buf.push_back(c);
-			break;
+public:
+	std::vector<char> data;
+
+	void write_number(uint64_t n)
+	{
+		for (unsigned i = 0; i != sizeof(n); ++i) {
+			this->data.push_back(char(uint8_t(n >> (i * bits_in_byte))));
+		}
 	}
-}
 
-void parser::process_char_in_raw_cpp_string_closing_sequence(char c, listener& listener)
-{
-	ASSERT(this->cur_state == state::raw_cpp_string_closing_sequence)
-	switch (c) {
-		case '"':
-			ASSERT(this->sequence_index <= this->sequence.size())
-			if (this->sequence_index != this->sequence.size()) {
-				this->buf.push_back(')');
-				for (size_t i = 0; i != this->sequence_index; ++i) {
-					this->buf.push_back(this->sequence[i]);
-				}
-				this->cur_state = state::raw_cpp_string;
-			} else {
-				this->sequence.clear();
-				// this->handle_string_parsed(listener);
-				this->set_string_parsed_state();
-			}
-			break;
-		default:
-			ASSERT(this->sequence_index <= this->sequence.size())
-			if (this->sequence_index == this->sequence.size() || c != this->sequence[this->sequence_index]) {
-				this->buf.push_back(')');
-				for (size_t i = 0; i != this->sequence_index; ++i) {
-					this->buf.push_back(this->sequence[i]);
-				}
-				this->cur_state = state::raw_cpp_string;
-			} else {
-				++this->sequence_index;
-			}
-			break;
+	void write_string(std::string_view str)
+	{
+		this->write_number(str.size());
+		this->data.insert(this->data.end(), str.begin(), str.end());
 	}
-}
 
-void parser::process_char_in_raw_quotes_string_opening_sequence(char c, listener& listener)
-{
-	ASSERT(this->cur_state == state::raw_quotes_string_opening_sequence)
-	ASSERT(this->buf.empty())
-	switch (c) {
-		case '"':
-			++this->sequence_index;
-			if (this->sequence_index == 3) {
-				this->cur_state = state::raw_quotes_string;
-				this->info.flags.set(flag::raw);
-				this->info.flags.set(flag::raw_quotes_style);
+	void write_extra_info(const extra_info& info)
+	{
+		this->write_number(info.location.line);
+		this->write_number(info.location.offset);
+		this->write_number(info.location.byte_offset);
+		this->write_number(info.length);
+
+		uint64_t flags = 0;
+		for (size_t i = 0; i != size_t(flag::enum_size); ++i) {
+			if (info.flags.get(flag(i))) {
+				flags |= uint64_t(1) << i;
 			}
-			break;
-		default:
-			this->info.flags.set(flag::quoted);
-			switch (this->sequence_index) {
-				default:
-					ASSERT(false)
-				case 1:
-					this->cur_state = state::quoted_string;
-					this->process_char_in_quoted_string(c, listener);
-					break;
-				case 2:
-					// empty quoted string
-					// this->handle_string_parsed(listener);
-					this->set_string_parsed_state();
-					this->process_char_in_string_parsed(c, listener);
-					break;
-			}
-			break;
+		}
+		this->write_number(flags);
 	}
-}
+};
 
-void parser::process_char_in_raw_quotes_string(char c, listener& listener)
+class snapshot_reader
 {
-	ASSERT(this->cur_state == state::raw_quotes_string)
-	switch (c) {
-		case '"':
-			this->cur_state = state::raw_quotes_string_closing_sequence;
-			this->sequence_index = 1;
-			break;
-		default:
-			this->buf.push_back(c);
-			break;
-	}
-}
+	utki::span<const char> data;
 
-void parser::process_char_in_raw_quotes_string_closing_sequence(char c, listener& listener)
-{
-	ASSERT(this->cur_state == state::raw_quotes_string_closing_sequence)
-	switch (c) {
-		case '"':
-			++this->sequence_index;
-			if (this->sequence_index == 3) {
-				// this->handle_string_parsed(listener);
-				this->set_string_parsed_state();
-			}
-			break;
-		default:
-			this->buf.insert(this->buf.end(), this->sequence_index, '"');
-			this->buf.push_back(c);
-			this->cur_state = state::raw_quotes_string;
-			break;
+	utki::span<const char> read_bytes(size_t size)
+	{
+		if (this->data.size() < size) {
+			internal::throw_exception(std::invalid_argument("tml::parser_snapshot::deserialize(): unexpected end of data"));
+		}
+		auto ret = this->data.subspan(0, size);
+		this->data = this->data.subspan(size);
+		return ret;
 	}
-}
 
-void parser::process_char(char c, listener& listener)
-{
-	switch (this->cur_state) {
-		case state::initial:
-			this->process_char_in_initial(c, listener);
-			break;
-		case state::idle:
-			this->process_char_in_idle(c, listener);
-			break;
-		case state::string_parsed:
-			this->process_char_in_string_parsed(c, listener);
-			break;
-		case state::unquoted_string:
-			this->process_char_in_unquoted_string(c, listener);
-			break;
-		case state::quoted_string:
-			this->process_char_in_quoted_string(c, listener);
-			break;
-		case state::escape_sequence:
-			this->process_char_in_escape_sequence(c, listener);
-			break;
-		case state::unicode_sequence:
-			this->process_char_in_unicode_sequence(c, listener);
-			break;
-		case state::comment_seqence:
-			this->process_char_in_comment_sequence(c, listener);
-			break;
-		case state::single_line_comment:
-			this->process_char_in_single_line_comment(c, listener);
-			break;
-		case state::multiline_comment:
-			this->process_char_in_multiline_comment(c, listener);
-			break;
-		case state::raw_cpp_string_opening_sequence:
-			this->process_char_in_raw_cpp_string_opening_sequence(c, listener);
-			break;
-		case state::raw_cpp_string:
-			this->process_char_in_raw_cpp_string(c, listener);
-			break;
-		case state::raw_cpp_string_closing_sequence:
-			this->process_char_in_raw_cpp_string_closing_sequence(c, listener);
-			break;
-		case state::raw_quotes_string_opening_sequence:
-			this->process_char_in_raw_quotes_string_opening_sequence(c, listener);
-			break;
-		case state::raw_quotes_string:
-			this->process_char_in_raw_quotes_string(c, listener);
-			break;
-		case state::raw_quotes_string_closing_sequence:
-			this->process_char_in_raw_quotes_string_closing_sequence(c, listener);
-			break;
-		default:
-			ASSERT(false, [&](auto& o) {
-				o << "this->cur_state = " << unsigned(this->cur_state);
-			})
-			break;
+public:
+	snapshot_reader(utki::span<const char> data) :
+		data(data)
+	{}
+
+	bool empty() const noexcept
+	{
+		return this->data.empty();
 	}
-}
 
-void parser::parse_data_chunk(utki::span<const char> chunk, listener& listener)
-{
-	for (auto c : chunk) {
-		if (c == '\n') {
-			this->next_line();
+	uint64_t read_number()
+	{
+		uint64_t ret = 0;
+		auto bytes = this->read_bytes(sizeof(ret));
+		for (unsigned i = 0; i != sizeof(ret); ++i) {
+			ret |= uint64_t(uint8_t(bytes[i])) << (i * bits_in_byte);
 		}
-		this->process_char(c, listener);
-		++this->cur_loc.offset;
+		return ret;
 	}
-}
-
-void parser::end_of_data(listener& listener)
-{
-	this->process_char('\0', listener);
 
-	if (this->nesting_level != 0) {
-		throw std::invalid_argument("Malformed tml document fed. Document end reached while parsing children block.");
+	std::string read_string()
+	{
+		auto size = this->read_number();
+		if (size > this->data.size()) {
+			internal::throw_exception(std::invalid_argument("tml::parser_snapshot::deserialize(): unexpected end of data"));
+		}
+		auto bytes = this->read_bytes(size_t(size));
+		return {bytes.data(), bytes.size()};
 	}
 
-	if (this->cur_state != state::idle) {
-		throw std::invalid_argument(
-			"Malformed tml document fed. After parsing all the data, the parser remained in the middle of some parsing task."
-		);
+	extra_info read_extra_info()
+	{
+		extra_info ret;
+		ret.location.line = size_t(this->read_number());
+		ret.location.offset = size_t(this->read_number());
+		ret.location.byte_offset = size_t(this->read_number());
+		ret.length = size_t(this->read_number());
+
+		auto flags = this->read_number();
+		for (size_t i = 0; i != size_t(flag::enum_size); ++i) {
+			ret.flags.set(flag(i), (flags & (uint64_t(1) << i)) != 0);
+		}
+		return ret;
 	}
+};
+} // namespace
 
-	this->reset();
+std::vector<char> parser_snapshot::serialize() const
+{
+	snapshot_writer w;
+
+	w.data.insert(w.data.end(), snapshot_signature.begin(), snapshot_signature.end());
+	w.write_number(snapshot_format_version);
+
+	w.write_string(this->string);
+	w.write_string(this->sequence);
+	w.write_number(this->sequence_index);
+	w.write_number(this->nesting_level);
+	w.write_number(this->skip_depth);
+	w.write_number(this->cur_state);
+	w.write_number(this->previous_state);
+	w.write_number(this->cur_line);
+	w.write_number(this->cur_line_start);
+	w.write_number(this->cur_byte_offset);
+	w.write_extra_info(this->info);
+	w.write_extra_info(this->string_parsed_info);
+
+	return std::move(w.data);
 }
 
-void tml::parse(const fsif::file& fi, listener& listener)
+parser_snapshot parser_snapshot::deserialize(utki::span<const char> data)
 {
-	fsif::file::guard file_guard(fi);
-
-	tml::parser parser;
-
-	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-	std::array<uint8_t, file_read_chunk_size> buf;
-
-	// size_t num_bytes_read;
-
-	for (;;) {
-		size_t num_bytes_read = fi.read(utki::make_span(buf));
+	if (utki::make_string_view(data.subspan(0, std::min(data.size(), snapshot_signature.size()))) !=
+		snapshot_signature)
+	{
+		internal::throw_exception(std::invalid_argument("tml::parser_snapshot::deserialize(): not a parser snapshot"));
+	}
 
-		parser.parse_data_chunk(utki::make_span(buf.data(), num_bytes_read), listener);
+	snapshot_reader r(data.subspan(snapshot_signature.size()));
 
-		if (num_bytes_read != buf.size()) {
-			break;
-		}
+	if (r.read_number() != snapshot_format_version) {
+		internal::throw_exception(std::invalid_argument(
+			"tml::parser_snapshot::deserialize(): unsupported snapshot format version"
+		));
 	}
 
-	parser.end_of_data(listener);
-}
+	parser_snapshot ret;
+
+	ret.string = r.read_string();
+	ret.sequence = r.read_string();
+	ret.sequence_index = size_t(r.read_number());
+	ret.nesting_level = unsigned(r.read_number());
+	ret.skip_depth = unsigned(r.read_number());
+	ret.cur_state = unsigned(r.read_number());
+	ret.previous_state = unsigned(r.read_number());
+	ret.cur_line = size_t(r.read_number());
+	ret.cur_line_start = size_t(r.read_number());
+	ret.cur_byte_offset = size_t(r.read_number());
+	ret.info = r.read_extra_info();
+	ret.string_parsed_info = r.read_extra_info();
+
+	if (!r.empty()) {
+		internal::throw_exception(std::invalid_argument(
+			"tml::parser_snapshot::deserialize(): unexpected data after the snapshot"
+		));
+	}
 
-void parser::reset()
-{
-	this->buf.clear();
-	this->nesting_level = 0;
-	this->cur_state = state::initial;
+	return ret;
 }
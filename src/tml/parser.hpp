@@ -26,12 +26,34 @@ SOFTWARE.
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include <fsif/file.hpp>
+#include <fsif/native_file.hpp>
+#include <utki/debug.hpp>
 #include <utki/span.hpp>
+#include <utki/string.hpp>
+#include <utki/unicode.hpp>
 
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+#include "diagnostics.hpp"
+#include "exception.hpp"
 #include "extra_info.hpp"
 
 /**
@@ -66,6 +88,7 @@ public:
 	/**
 	 * @brief Children list parsing finished.
 	 * This method is called by Parser when '}' token has been parsed.
+	 * The parser does not call this method for '}' which has no matching '{'.
 	 */
 	virtual void on_children_parse_finished(location loc) = 0;
 
@@ -80,24 +103,406 @@ public:
 	virtual ~listener() = default;
 };
 
+namespace internal {
+
+inline unsigned count_trailing_zeros(uint64_t v)
+{
+	ASSERT(v != 0)
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index = 0;
+	_BitScanForward64(&index, v);
+	return unsigned(index);
+#elif defined(_MSC_VER)
+	unsigned long index = 0;
+	if (_BitScanForward(&index, uint32_t(v))) {
+		return unsigned(index);
+	}
+	_BitScanForward(&index, uint32_t(v >> 32)); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	return unsigned(index) + 32; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+#else
+	return unsigned(__builtin_ctzll(v));
+#endif
+}
+
+/**
+ * @brief Size of data block described by one word of structural index.
+ */
+constexpr size_t index_block_size = sizeof(uint64_t) * 8;
+
+/**
+ * @brief Match block of data against set of characters.
+ * The data is compared in blocks of 32 bytes with AVX2 or 16 bytes with SSE2 if available,
+ * otherwise byte by byte.
+ * @tparam chars - characters to match.
+ * @param block - pointer to index_block_size bytes of data.
+ * @return Bitmask where bit number i is set if i-th byte of the block is one of the characters.
+ */
+template <char... chars>
+uint64_t match_any_of(const char* block)
+{
+	uint64_t mask = 0;
+
+#if defined(__AVX2__)
+	for (size_t i = 0; i != index_block_size; i += sizeof(__m256i)) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-type-reinterpret-cast)
+		auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+		auto matches = _mm256_setzero_si256();
+		((matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(data, _mm256_set1_epi8(chars)))), ...);
+		mask |= uint64_t(uint32_t(_mm256_movemask_epi8(matches))) << i;
+	}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	for (size_t i = 0; i != index_block_size; i += sizeof(__m128i)) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-type-reinterpret-cast)
+		auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+		auto matches = _mm_setzero_si128();
+		((matches = _mm_or_si128(matches, _mm_cmpeq_epi8(data, _mm_set1_epi8(chars)))), ...);
+		mask |= uint64_t(uint32_t(_mm_movemask_epi8(matches))) << i;
+	}
+#else
+	for (size_t i = 0; i != index_block_size; ++i) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto c = block[i];
+		if (((c == chars) || ...)) {
+			mask |= uint64_t(1) << i;
+		}
+	}
+#endif
+
+	return mask;
+}
+
+/**
+ * @brief Find first occurrence of any of the given characters.
+ * The data is scanned in blocks of index_block_size bytes using match_any_of(),
+ * the remaining tail is scanned byte by byte.
+ * @tparam chars - characters to search for.
+ * @param data - data to search in.
+ * @return Index of the first found character.
+ * @return data.size() if none of the characters was found.
+ */
+template <char... chars>
+size_t find_any_of(utki::span<const char> data)
+{
+	size_t i = 0;
+
+	for (; data.size() - i >= index_block_size; i += index_block_size) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (auto mask = match_any_of<chars...>(data.data() + i); mask != 0) {
+			return i + count_trailing_zeros(mask);
+		}
+	}
+
+	for (; i != data.size(); ++i) {
+		auto c = data[i];
+		if (((c == chars) || ...)) {
+			return i;
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief Check if character is one of the given characters.
+ * @tparam chars - characters to check against.
+ * @param c - character to check.
+ * @return true if the character is one of the given characters.
+ * @return false otherwise.
+ */
+template <char... chars>
+constexpr bool is_any_of(char c) noexcept
+{
+	return ((c == chars) || ...);
+}
+
+/**
+ * @brief Build structural index of the data.
+ * The structural characters are the ones which are handled specially by at least one of
+ * the parser states which consume plain characters in bulk, plus the new line character.
+ * All the other characters are plain characters in those states.
+ * @param data - data to index.
+ * @param index - output bitmap, bit number i is set if i-th byte of data is a structural character.
+ *                Must have at least (data.size() + index_block_size - 1) / index_block_size elements.
+ */
+inline void index_structural_chars(utki::span<const char> data, utki::span<uint64_t> index)
+{
+	auto match = [](const char* block) {
+		return match_any_of<'\0', '\t', '\n', '\r', ' ', '"', '\\', '{', '}', ')', '*', '/'>(block);
+	};
+
+	auto dst = index.begin();
+
+	size_t i = 0;
+	for (; data.size() - i >= index_block_size; i += index_block_size, ++dst) {
+		ASSERT(dst != index.end())
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		*dst = match(data.data() + i);
+	}
+
+	if (i != data.size()) {
+		ASSERT(dst != index.end())
+
+		// pad the last incomplete block with non-structural characters
+		std::array<char, index_block_size> block{};
+		block.fill('a');
+		std::copy(std::next(data.begin(), ptrdiff_t(i)), data.end(), block.begin());
+		*dst = match(block.data());
+	}
+}
+
+/**
+ * @brief Find next structural character using structural index.
+ * @param index - structural index of the data.
+ * @param pos - position in the data to start search from.
+ * @param size - size of the indexed data.
+ * @return Position of the next structural character at or after pos.
+ * @return size if there are no more structural characters.
+ */
+inline size_t find_next_structural_char(utki::span<const uint64_t> index, size_t pos, size_t size)
+{
+	size_t block = pos / index_block_size;
+	if (pos >= size) {
+		return size;
+	}
+
+	uint64_t bits = index[block] & (~uint64_t(0) << (pos % index_block_size));
+	while (bits == 0) {
+		++block;
+		if (block * index_block_size >= size) {
+			return size;
+		}
+		bits = index[block];
+	}
+
+	return block * index_block_size + count_trailing_zeros(bits);
+}
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ * Memory mapping is only supported on POSIX platforms, on other platforms
+ * the object is always left unmapped.
+ */
+class file_mapping
+{
+	int fd = -1;
+	void* ptr = nullptr;
+	size_t size = 0;
+
+public:
+	/**
+	 * @brief Constructor.
+	 * In case the file cannot be opened or mapped, the object is left unmapped,
+	 * no exception is thrown.
+	 * @param path - path to the file to map.
+	 */
+	file_mapping(const std::string& path);
+
+	file_mapping(const file_mapping&) = delete;
+	file_mapping& operator=(const file_mapping&) = delete;
+
+	file_mapping(file_mapping&&) = delete;
+	file_mapping& operator=(file_mapping&&) = delete;
+
+	~file_mapping();
+
+	bool is_mapped() const noexcept
+	{
+		return this->ptr != nullptr;
+	}
+
+	utki::span<const char> data() const noexcept
+	{
+		ASSERT(this->is_mapped())
+		return utki::make_span(static_cast<const char*>(this->ptr), this->size);
+	}
+};
+
+/**
+ * @brief Check if listener needs extra info of parsed strings.
+ * The listener can declare that it does not need the extra info with
+ * constexpr static bool needs_extra_info = false;
+ * member.
+ */
+template <typename listener_type, typename = void>
+struct listener_needs_extra_info : std::true_type {};
+
+template <typename listener_type>
+struct listener_needs_extra_info<listener_type, std::void_t<decltype(listener_type::needs_extra_info)>> :
+	std::bool_constant<listener_type::needs_extra_info> {};
+
+/**
+ * @brief Check if listener takes ownership of parsed strings.
+ * The listener can declare a
+ * void on_string_parsed(std::string&& str, const extra_info& info);
+ * method, possibly in addition to the std::string_view one. In that case the parser
+ * hands over its string buffer to the listener instead of passing a view to it,
+ * so that the listener does not need to copy the string once again.
+ */
+template <typename listener_type, typename = void>
+struct listener_takes_string_ownership : std::false_type {};
+
+template <typename listener_type>
+struct listener_takes_string_ownership<
+	listener_type,
+	std::void_t<decltype(static_cast<void (listener_type::*)(std::string&&, const extra_info&)>(
+		&listener_type::on_string_parsed
+	))>> : std::true_type {};
+
+// Starts parsing in the middle of a document, used by tml::reparse_ext().
+class region_parsing;
+
+} // namespace internal
+
+/**
+ * @brief Saved state of a parser.
+ * The snapshot is taken with basic_parser::snapshot() in between the data chunks. It can be restored
+ * to the same or to another parser object with basic_parser::restore(), after that the parser continues
+ * parsing from the point where the snapshot was taken. The snapshot does not refer to the parsed data,
+ * all the needed parts of it, e.g. the unfinished string, are copied to the snapshot.
+ * Note, that the state of the listener is not a part of the parser snapshot.
+ * The snapshot can be serialized to a byte array, e.g. to be stored as a checkpoint, and deserialized back.
+ */
+class parser_snapshot
+{
+	template <typename, bool>
+	friend class basic_parser;
+
+	std::string string;
+	std::string sequence;
+	size_t sequence_index = 0;
+	unsigned nesting_level = 0;
+	unsigned skip_depth = 0;
+	unsigned cur_state = 0;
+	unsigned previous_state = 0;
+	size_t cur_line = 1;
+	size_t cur_line_start = 0;
+	size_t cur_byte_offset = 0;
+	extra_info info;
+	extra_info string_parsed_info;
+
+public:
+	/**
+	 * @brief Serialize the snapshot.
+	 * The serialized form does not depend on the platform.
+	 * @return Serialized snapshot.
+	 */
+	std::vector<char> serialize() const;
+
+	/**
+	 * @brief Deserialize snapshot.
+	 * @param data - serialized snapshot, as returned by serialize().
+	 * @return Deserialized snapshot.
+	 * @throw std::invalid_argument - in case the data is not a valid serialized snapshot.
+	 */
+	static parser_snapshot deserialize(utki::span<const char> data);
+};
+
+/**
+ * @brief Check if tml document is well-formed.
+ * The document is checked for balanced curly braces, terminated strings and comments
+ * and valid unicode escape sequences. The check is done by the same state machine as tml::parser uses,
+ * but the strings are not buffered, no listener is notified and no exceptions are thrown,
+ * so the check does not allocate heap memory and is faster than reading the document.
+ * @param data - the tml document.
+ * @return true if the document is well-formed.
+ * @return false otherwise.
+ */
+bool validate(utki::span<const char> data);
+
 /**
  * @brief tml parser.
  * This is a class of tml parser. It is used for event-based parsing of tml
  * documents.
+ * The listener methods are called directly on the listener_type, so in case the listener_type
+ * is a concrete class with non-virtual methods, the calls can be inlined by the compiler.
+ * See tml::parser for the parser which works with tml::listener interface.
+ * @tparam listener_type - type of the listener which receives notifications about parsed tokens.
+ *                         It has to provide the same methods as tml::listener, but they need not be virtual.
+ *                         Instead of on_string_parsed(std::string_view, const extra_info&) it can provide
+ *                         on_string_parsed(std::string&&, const extra_info&) to take ownership of parsed strings,
+ *                         see internal::listener_takes_string_ownership.
+ * @tparam track_extra_info - whether to track locations and formatting flags of parsed strings.
+ *                            In case it is false, the locations and formatting flags of parsed strings passed to the listener
+ *                            are not valid, only the raw flag is, and the per-token bookkeeping is skipped which makes parsing faster.
+ *                            The locations of children lists, of diagnostics and in error messages are valid in any case.
+ *                            By default it is false if the listener_type declares that it does not need the extra info,
+ *                            see internal::listener_needs_extra_info.
  */
-class parser
+template <typename listener_type, bool track_extra_info = internal::listener_needs_extra_info<listener_type>::value>
+class basic_parser
 {
-	// buffer for current string being parsed
-	std::vector<char> buf;
+	// validation is done by skipping the whole document
+	friend bool tml::validate(utki::span<const char> data);
+
+	friend class internal::region_parsing;
+
+	// buffer for current string being parsed,
+	// short strings, e.g. the first characters of skipped strings, are stored without heap allocation
+	std::string buf;
+
+	// In case the current string being parsed lies entirely within the data chunk being parsed
+	// and needs no unescaping, then it is referred directly in the chunk instead of being copied to the buffer.
+	// Only one of 'buf' and 'chunk_string' can be non-empty at a time.
+	utki::span<const char> chunk_string;
+
+	// character being processed, refers to the data chunk being parsed
+	utki::span<const char> cur_char;
+
+	utki::span<const char> get_string() const noexcept;
+	bool is_string_empty() const noexcept;
+	void clear_string() noexcept;
+	void move_chunk_string_to_buffer();
+	void append_to_string(char c);
+
+	// the appended characters are expected to come from the data chunk being parsed
+	void append_to_string(utki::span<const char> chunk_chars);
+
+	void append_cur_char_to_string(char c);
+
+	// returns true if the parser is skipping and the characters were handled as a part of skipped string
+	bool append_skipped_string(utki::span<const char> chars);
+
+	// number of hexadecimal digits in \u and \U escape sequences
+	constexpr static size_t short_unicode_sequence_length = 4;
+	constexpr static size_t long_unicode_sequence_length = 8;
 
 	// used for raw string open/close sequences, unicode sequences etc.
 	std::string sequence;
+
+	// In case the C++ style raw string delimiter lies entirely within the data chunk being parsed,
+	// then it is referred directly in the chunk instead of being copied to the sequence.
+	// Only one of 'sequence' and 'chunk_sequence' can be non-empty at a time.
+	utki::span<const char> chunk_sequence;
+
 	// current index into the sequence string
 	size_t sequence_index = 0;
 
+	utki::span<const char> get_sequence() const noexcept;
+	void clear_sequence() noexcept;
+
+	// copies the parts of the data chunk the parser refers to, i.e. the string and the sequence, to the own buffers
+	void release_chunk();
+
+	// Same as parse_data_chunk(), but the parser may keep referring to the chunk data after returning,
+	// so the chunk has to stay valid until release_chunk() or end_of_data() is called.
+	void parse_data_chunk_in_place(utki::span<const char> chunk, listener_type& listener);
+
 	// this variable is used for tracking current nesting level to make checks for detecting malformed tml document
 	unsigned nesting_level = 0;
 
+	// nesting level of children list relative to the one being skipped, 0 means not skipping
+	unsigned skip_depth = 0;
+
+	// in case it is set, the parser reports problems of malformed document to it instead of throwing
+	diagnostics_sink* diagnostics = nullptr;
+
+	void report(diagnostic_kind kind);
+	void recover_unterminated_token();
+
+	void notify_string_parsed(std::string_view str, const extra_info& info, listener_type& listener);
+	void notify_children_parse_started(listener_type& listener);
+	void notify_children_parse_finished(listener_type& listener);
+
 	enum class state {
 		initial, // state before parsing the first node
 		idle,
@@ -119,28 +524,61 @@ class parser
 
 	state previous_state = state::idle;
 
-	void handle_string_parsed(tml::listener& listener);
-
-	void process_char(char c, tml::listener& listener);
-	void process_char_in_initial(char c, tml::listener& listener);
-	void process_char_in_idle(char c, tml::listener& listener);
-	void process_char_in_string_parsed(char c, tml::listener& listener);
-	void process_char_in_unquoted_string(char c, tml::listener& listener);
-	void process_char_in_quoted_string(char c, tml::listener& listener);
-	void process_char_in_escape_sequence(char c, tml::listener& listener);
-	void process_char_in_unicode_sequence(char c, tml::listener& listener);
-	void process_char_in_comment_sequence(char c, tml::listener& listener);
-	void process_char_in_single_line_comment(char c, tml::listener& listener);
-	void process_char_in_multiline_comment(char c, tml::listener& listener);
-	void process_char_in_raw_cpp_string_opening_sequence(char c, tml::listener& listener);
-	void process_char_in_raw_cpp_string(char c, tml::listener& listener);
-	void process_char_in_raw_cpp_string_closing_sequence(char c, tml::listener& listener);
-	void process_char_in_raw_quotes_string_opening_sequence(char c, tml::listener& listener);
-	void process_char_in_raw_quotes_string(char c, tml::listener& listener);
-	void process_char_in_raw_quotes_string_closing_sequence(char c, tml::listener& listener);
+	void handle_string_parsed(listener_type& listener);
 
-	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
-	location cur_loc = {1, 1}; // offset starts with 1
+	// Returns true if the current state consumes characters which need no special handling in bulk.
+	bool consumes_plain_chars() const noexcept;
+
+	// Returns true if the character needs special handling in the current state.
+	// Only valid for states which consume plain characters in bulk.
+	bool is_special_char(char c) const noexcept;
+
+	// Consumes run of characters which need no special handling in the current state,
+	// i.e. which are appended to the string being parsed or skipped as a part of comment, all at once.
+	void consume_plain_chars(utki::span<const char> run);
+
+	void parse_indexed_window(
+		utki::span<const char> window, //
+		utki::span<const uint64_t> index,
+		listener_type& listener
+	);
+
+	void process_char(char c, listener_type& listener);
+	void process_char_in_initial(char c, listener_type& listener);
+	void process_char_in_idle(char c, listener_type& listener);
+	void process_char_in_string_parsed(char c, listener_type& listener);
+	void process_char_in_unquoted_string(char c, listener_type& listener);
+	void process_char_in_quoted_string(char c, listener_type& listener);
+	void process_char_in_escape_sequence(char c, listener_type& listener);
+	void process_char_in_unicode_sequence(char c, listener_type& listener);
+	void process_char_in_comment_sequence(char c, listener_type& listener);
+	void process_char_in_single_line_comment(char c, listener_type& listener);
+	void process_char_in_multiline_comment(char c, listener_type& listener);
+	void process_char_in_raw_cpp_string_opening_sequence(char c, listener_type& listener);
+	void process_char_in_raw_cpp_string(char c, listener_type& listener);
+	void process_char_in_raw_cpp_string_closing_sequence(char c, listener_type& listener);
+	void process_char_in_raw_quotes_string_opening_sequence(char c, listener_type& listener);
+	void process_char_in_raw_quotes_string(char c, listener_type& listener);
+	void process_char_in_raw_quotes_string_closing_sequence(char c, listener_type& listener);
+
+	// Position of the current character. Only the line number, the byte offset and the byte offset
+	// of the current line beginning are tracked, the offset within the line is computed from those when needed.
+	// The position is tracked even if the extra info tracking is disabled, so that the errors are reported
+	// with valid locations. It costs little, as new line is a structural character and plain characters
+	// are counted in runs.
+	size_t cur_line = 1;
+	size_t cur_line_start = 0;
+	size_t cur_byte_offset = 0;
+
+	location get_cur_loc() const noexcept
+	{
+		// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+		return {
+			this->cur_line,
+			this->cur_byte_offset - this->cur_line_start + 1, // offset starts with 1
+			this->cur_byte_offset
+		};
+	}
 
 	void next_line();
 
@@ -152,6 +590,29 @@ class parser
 
 	void set_string_start_pos();
 
+	// The formatting flags are only tracked in case the extra info tracking is enabled,
+	// the raw flag is always tracked, because it is needed for parsing itself.
+	template <flag f>
+	static void set_flag(extra_info& i) noexcept
+	{
+		if constexpr (track_extra_info || f == flag::raw) {
+			i.flags.set(f);
+		}
+	}
+
+	template <flag f>
+	static void clear_flag(extra_info& i) noexcept
+	{
+		if constexpr (track_extra_info || f == flag::raw) {
+			i.flags.clear(f);
+		}
+	}
+
+	void advance_offset(size_t num_chars) noexcept
+	{
+		this->cur_byte_offset += num_chars;
+	}
+
 	void set_string_parsed_state();
 
 public:
@@ -159,7 +620,7 @@ public:
 	 * @brief Constructor.
 	 * Creates an initially reset Parser object.
 	 */
-	parser()
+	basic_parser()
 	{
 		this->reset();
 	}
@@ -167,6 +628,8 @@ public:
 	/**
 	 * @brief Reset parser.
 	 * Resets the parser to initial state, discarding all the temporary parsed data and state.
+	 * After reset the parser behaves as a newly constructed one, e.g. it can parse a new document
+	 * after the previous one has failed to parse.
 	 */
 	void reset();
 
@@ -176,9 +639,9 @@ public:
 	 * @param chunk - data chunk to parse.
 	 * @param listener - listener object which will receive notifications about parsed tokens.
 	 */
-	void parse_data_chunk(utki::span<const char> chunk, listener& listener);
+	void parse_data_chunk(utki::span<const char> chunk, listener_type& listener);
 
-	void parse_data_chunk(utki::span<const uint8_t> chunk, listener& listener)
+	void parse_data_chunk(utki::span<const uint8_t> chunk, listener_type& listener)
 	{
 		this->parse_data_chunk(to_char(chunk), listener);
 	}
@@ -190,15 +653,1503 @@ public:
 	 * is.
 	 * @param listener - listener object which will receive notifications about parsed tokens.
 	 */
-	void end_of_data(listener& listener);
+	void end_of_data(listener_type& listener);
+
+	/**
+	 * @brief Set diagnostics sink.
+	 * In case the diagnostics sink is set, the parser does not throw on malformed document, instead it reports
+	 * the problems to the diagnostics sink, recovers and continues parsing, see tml::diagnostic_kind for the recovery
+	 * rules. So, all the problems of the document are found in a single pass.
+	 * @param sink - diagnostics sink, nullptr to throw on malformed document.
+	 */
+	void set_diagnostics_sink(diagnostics_sink* sink) noexcept
+	{
+		this->diagnostics = sink;
+	}
+
+	/**
+	 * @brief Skip the rest of the current children list.
+	 * After calling this method the parser does not notify the listener about parsed tokens
+	 * until the end of the current children list, and then notifies on_children_parse_finished().
+	 * The skipped data is only scanned to track the children lists nesting, strings and comments,
+	 * the skipped strings are not unescaped nor buffered.
+	 * Normally, this method is called from the listener's on_children_parse_started()
+	 * to skip the whole children list.
+	 * @throw std::logic_error - in case the parser is not inside of a children list.
+	 */
+	void skip_children()
+	{
+		if (this->nesting_level == 0) {
+			internal::throw_exception(std::logic_error("tml::parser::skip_children(): not inside of a children list"));
+		}
+		if (this->skip_depth == 0) {
+			this->skip_depth = 1;
+		}
+	}
+
+	/**
+	 * @brief Check if parser is at top level, between nodes.
+	 * The parser is at top level when all the children blocks parsed so far are closed and
+	 * the parser is not in the middle of a string or a comment. Note, that the last parsed string
+	 * might still be waiting for its children block, i.e. it will be reported to the listener only when
+	 * next token is encountered or on end_of_data().
+	 * In this state, the rest of the document, in case it does not start with a children block, can be parsed
+	 * by a separate parser object, after finalizing this parser with end_of_data().
+	 * @return true if the parser is at top level.
+	 * @return false otherwise.
+	 */
+	bool is_at_top_level() const noexcept
+	{
+		if (this->nesting_level != 0) {
+			return false;
+		}
+
+		switch (this->cur_state) {
+			case state::initial:
+			case state::idle:
+			case state::string_parsed:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * @brief Take snapshot of the parser state.
+	 * The snapshot can only be taken in between the data chunks, i.e. not from within the listener callbacks.
+	 * @return The parser state snapshot.
+	 */
+	parser_snapshot snapshot() const;
+
+	/**
+	 * @brief Restore parser state from snapshot.
+	 * The parser can be a different parser object than the one the snapshot was taken from.
+	 * @param s - snapshot to restore the state from.
+	 * @throw std::invalid_argument - in case the snapshot is invalid.
+	 */
+	void restore(const parser_snapshot& s);
 };
 
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::next_line()
+{
+	++this->cur_line;
+	// the new line character itself has offset 0 on the new line
+	this->cur_line_start = this->cur_byte_offset + 1;
+}
+
+template <typename listener_type, bool track_extra_info>
+utki::span<const char> basic_parser<listener_type, track_extra_info>::get_string() const noexcept
+{
+	if (this->buf.empty()) {
+		return this->chunk_string;
+	}
+	ASSERT(this->chunk_string.empty())
+	return utki::make_span(this->buf.data(), this->buf.size());
+}
+
+template <typename listener_type, bool track_extra_info>
+bool basic_parser<listener_type, track_extra_info>::is_string_empty() const noexcept
+{
+	return this->buf.empty() && this->chunk_string.empty();
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::clear_string() noexcept
+{
+	this->buf.clear();
+	this->chunk_string = {};
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::move_chunk_string_to_buffer()
+{
+	ASSERT(this->buf.empty() || this->chunk_string.empty())
+	this->buf.insert(this->buf.end(), this->chunk_string.begin(), this->chunk_string.end());
+	this->chunk_string = {};
+}
+
+template <typename listener_type, bool track_extra_info>
+utki::span<const char> basic_parser<listener_type, track_extra_info>::get_sequence() const noexcept
+{
+	if (this->sequence.empty()) {
+		return this->chunk_sequence;
+	}
+	ASSERT(this->chunk_sequence.empty())
+	return utki::make_span(this->sequence.data(), this->sequence.size());
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::clear_sequence() noexcept
+{
+	this->sequence.clear();
+	this->chunk_sequence = {};
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::release_chunk()
+{
+	this->move_chunk_string_to_buffer();
+
+	ASSERT(this->sequence.empty() || this->chunk_sequence.empty())
+	this->sequence.append(this->chunk_sequence.data(), this->chunk_sequence.size());
+	this->chunk_sequence = {};
+}
+
+template <typename listener_type, bool track_extra_info>
+bool basic_parser<listener_type, track_extra_info>::append_skipped_string(utki::span<const char> chars)
+{
+	// The raw C++ string delimiter is needed to find the end of the raw string.
+	if (this->skip_depth == 0 || this->cur_state == state::raw_cpp_string_opening_sequence) {
+		return false;
+	}
+
+	// The skipped string is not reported, so only keep its first characters which
+	// are enough for the checks done by the state machine, e.g. detecting raw C++ string opening 'R'.
+	constexpr size_t max_skipped_string_size = 2;
+
+	this->move_chunk_string_to_buffer();
+	if (this->buf.size() < max_skipped_string_size) {
+		chars = chars.subspan(0, std::min(chars.size(), max_skipped_string_size - this->buf.size()));
+		this->buf.insert(this->buf.end(), chars.begin(), chars.end());
+	}
+	return true;
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::append_to_string(char c)
+{
+	if (this->append_skipped_string(utki::make_span(&c, 1))) {
+		return;
+	}
+
+	this->move_chunk_string_to_buffer();
+	this->buf.push_back(c);
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::append_to_string(utki::span<const char> chunk_chars)
+{
+	if (chunk_chars.empty()) {
+		return;
+	}
+
+	if (this->append_skipped_string(chunk_chars)) {
+		return;
+	}
+
+	if (this->buf.empty()) {
+		if (this->chunk_string.empty()) {
+			this->chunk_string = chunk_chars;
+			return;
+		}
+		if (utki::end_pointer(this->chunk_string) == chunk_chars.data()) {
+			this->chunk_string = utki::make_span(
+				this->chunk_string.data(), //
+				this->chunk_string.size() + chunk_chars.size()
+			);
+			return;
+		}
+		this->move_chunk_string_to_buffer();
+	}
+
+	this->buf.insert(this->buf.end(), chunk_chars.begin(), chunk_chars.end());
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::append_cur_char_to_string(char c)
+{
+	if (this->cur_char.empty()) {
+		// the character does not come from the data chunk, e.g. it is the end of data marker
+		this->append_to_string(c);
+		return;
+	}
+	ASSERT(this->cur_char.front() == c)
+	this->append_to_string(this->cur_char);
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::notify_string_parsed(
+	std::string_view str, //
+	const extra_info& info,
+	listener_type& listener
+)
+{
+	if (this->skip_depth != 0) {
+		return;
+	}
+	if constexpr (internal::listener_takes_string_ownership<listener_type>::value) {
+		listener.on_string_parsed(std::string(str), info);
+	} else {
+		listener.on_string_parsed(str, info);
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::notify_children_parse_started(listener_type& listener)
+{
+	++this->nesting_level;
+
+	if (this->skip_depth != 0) {
+		++this->skip_depth;
+		return;
+	}
+	listener.on_children_parse_started(this->get_cur_loc());
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::notify_children_parse_finished(listener_type& listener)
+{
+	if (this->nesting_level == 0) {
+		if (this->diagnostics) {
+			this->report(diagnostic_kind::unexpected_closing_curly_brace);
+			return;
+		}
+		auto loc = this->get_cur_loc();
+		std::stringstream ss;
+		ss << "malformed tml: unopened curly brace encountered at " << loc.line << ":" << loc.offset;
+		internal::throw_exception(std::invalid_argument(ss.str()));
+	}
+
+	if (this->skip_depth != 0) {
+		--this->skip_depth;
+		if (this->skip_depth != 0) {
+			--this->nesting_level;
+			return;
+		}
+	}
+	listener.on_children_parse_finished(this->get_cur_loc());
+	--this->nesting_level;
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::handle_string_parsed(listener_type& listener)
+{
+	auto span = this->get_string();
+
+	if (this->string_parsed_info.flags.get(flag::raw)) {
+		if (span.size() >= 2 && span[0] == '\r' && span[1] == '\n') {
+			span = span.subspan(2);
+		} else if (span.size() >= 1 && span[0] == '\n') {
+			span = span.subspan(1);
+		}
+
+		if (span.size() >= 1 && span.back() == '\n') {
+			span = span.subspan(0, span.size() - 1);
+		}
+
+		if (span.size() >= 1 && span.back() == '\r') {
+			span = span.subspan(0, span.size() - 1);
+		}
+	}
+
+	if constexpr (internal::listener_takes_string_ownership<listener_type>::value) {
+		if (this->skip_depth == 0 && !this->buf.empty()) {
+			// hand over the buffer to the listener, the parser starts a fresh one
+			auto begin = size_t(span.data() - this->buf.data());
+			auto size = span.size();
+
+			std::string str = std::move(this->buf);
+			this->buf.clear();
+
+			str.resize(begin + size);
+			str.erase(0, begin);
+
+			listener.on_string_parsed(std::move(str), this->string_parsed_info);
+			this->clear_string();
+			return;
+		}
+	}
+
+	this->notify_string_parsed(utki::make_string_view(span), this->string_parsed_info, listener);
+	this->clear_string();
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::set_string_start_pos()
+{
+	if constexpr (track_extra_info) {
+		this->info.location = this->get_cur_loc();
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_initial(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::initial)
+	switch (c) {
+		case '\n':
+			this->set_flag<flag::first_on_line>(this->info);
+		case ' ':
+		case '\t':
+		case '\r':
+			break;
+		case '/':
+			this->set_string_start_pos();
+			this->previous_state = state::initial;
+			this->cur_state = state::comment_seqence;
+			break;
+		case '\0':
+			this->cur_state = state::idle; // parser should remain in idle state after data end
+			break;
+		default:
+			this->process_char_in_idle(c, listener);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_idle(char c, listener_type& listener)
+{
+	switch (c) {
+		case '\n':
+			this->set_flag<flag::first_on_line>(this->info);
+		case ' ':
+		case '\t':
+		case '\r':
+			this->set_flag<flag::space>(this->info);
+			break;
+		case '\0':
+			break;
+		case '{':
+			ASSERT(this->is_string_empty())
+			if (this->diagnostics) {
+				this->report(diagnostic_kind::unexpected_opening_curly_brace);
+
+				// recover by assuming an empty string before the curly brace
+				this->set_string_start_pos();
+				this->set_string_parsed_state();
+				this->process_char_in_string_parsed(c, listener);
+				break;
+			}
+			{
+				std::stringstream ss;
+				ss << "Malformed tml document fed. Unexpected { at line: " << this->cur_line;
+				internal::throw_exception(std::invalid_argument(ss.str()));
+			}
+			break;
+		case '}':
+			this->notify_children_parse_finished(listener);
+
+			// Some other states forward processing to 'process_char_in_idle()' by explicitly calling it,
+			// thus this function can be called even when parser is not in idle state.
+			// This is why here we set the state to idle.
+			this->cur_state = state::idle;
+
+			this->clear_flag<flag::space>(this->info);
+			break;
+		case '"':
+			this->set_string_start_pos();
+			this->cur_state = state::raw_quotes_string_opening_sequence;
+			this->sequence_index = 1;
+			break;
+		case '/':
+			this->set_string_start_pos();
+			this->previous_state = state::idle;
+			this->cur_state = state::comment_seqence;
+			break;
+		case '\\':
+			this->set_string_start_pos();
+			this->previous_state = state::unquoted_string;
+			this->cur_state = state::escape_sequence;
+			break;
+		default:
+			this->append_cur_char_to_string(c);
+			this->set_string_start_pos();
+			this->cur_state = state::unquoted_string;
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::set_string_parsed_state()
+{
+	if constexpr (track_extra_info) {
+		size_t end = this->cur_byte_offset;
+		switch (this->cur_state) {
+			case state::quoted_string:
+			case state::raw_cpp_string_opening_sequence:
+			case state::raw_cpp_string_closing_sequence:
+			case state::raw_quotes_string_closing_sequence:
+				// current character is the closing double quote, it belongs to the token
+				++end;
+				break;
+			default:
+				// current character is the first one after the token
+				break;
+		}
+		this->info.length = end - this->info.location.byte_offset;
+	}
+
+	this->string_parsed_info = this->info;
+	this->info.flags.clear();
+	this->cur_state = state::string_parsed;
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_string_parsed(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::string_parsed)
+	switch (c) {
+		case '\n':
+			this->set_flag<flag::first_on_line>(this->info);
+		case ' ':
+		case '\r':
+		case '\t':
+			this->set_flag<flag::space>(this->info);
+			break;
+		case '/':
+			this->set_string_start_pos();
+			this->previous_state = state::string_parsed;
+			this->cur_state = state::comment_seqence;
+			break;
+		case '{':
+			this->set_flag<flag::curly_braces>(this->string_parsed_info);
+			this->handle_string_parsed(listener);
+			this->notify_children_parse_started(listener);
+			this->cur_state = state::initial;
+			this->clear_flag<flag::space>(this->info);
+			this->clear_flag<flag::first_on_line>(this->info);
+			break;
+		default:
+			this->handle_string_parsed(listener);
+			this->cur_state = state::idle;
+			this->process_char_in_idle(c, listener);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_unquoted_string(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::unquoted_string)
+	switch (c) {
+		case '"':
+			ASSERT(!this->is_string_empty())
+			if (auto str = this->get_string(); str.size() == 1 && str.back() == 'R') {
+				this->clear_string();
+				this->sequence.clear();
+				this->cur_state = state::raw_cpp_string_opening_sequence;
+			} else {
+				this->set_string_parsed_state();
+				this->handle_string_parsed(listener);
+				this->cur_state = state::raw_quotes_string_opening_sequence;
+				this->sequence_index = 1;
+				this->set_string_start_pos();
+			}
+			break;
+		case '\n':
+		case ' ':
+		case '\r':
+		case '\t':
+			ASSERT(!this->is_string_empty())
+			// this->handle_string_parsed(listener);
+			this->set_string_parsed_state();
+
+			this->set_flag<flag::space>(this->info);
+			if (c == '\n') {
+				this->set_flag<flag::first_on_line>(this->info);
+			}
+			break;
+		case '\0': // end of data
+			ASSERT(!this->is_string_empty())
+			this->set_string_parsed_state();
+			this->handle_string_parsed(listener);
+			this->cur_state = state::idle;
+			break;
+		case '\\':
+			this->previous_state = this->cur_state;
+			this->cur_state = state::escape_sequence;
+			break;
+		case '{':
+			ASSERT(!this->is_string_empty())
+			this->set_flag<flag::curly_braces>(this->info);
+			this->set_string_parsed_state();
+			this->handle_string_parsed(listener);
+			this->cur_state = state::initial;
+			this->notify_children_parse_started(listener);
+			break;
+		case '}':
+			ASSERT(!this->is_string_empty())
+			this->set_string_parsed_state();
+			this->handle_string_parsed(listener);
+			this->cur_state = state::idle;
+			this->notify_children_parse_finished(listener);
+			break;
+		default:
+			this->append_cur_char_to_string(c);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_quoted_string(char c, listener_type&)
+{
+	ASSERT(this->cur_state == state::quoted_string)
+	switch (c) {
+		case '"':
+			this->set_string_parsed_state();
+			break;
+		case '\\':
+			this->previous_state = this->cur_state;
+			this->cur_state = state::escape_sequence;
+			break;
+		case '\n':
+		case '\r':
+		case '\t':
+			break;
+		default:
+			this->append_cur_char_to_string(c);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_escape_sequence(char c, listener_type& listener)
+{
+	utki::assert(this->cur_state == state::escape_sequence, SL);
+	switch (c) {
+		case 'u':
+			this->cur_state = state::unicode_sequence;
+			this->sequence_index = 0;
+			this->sequence.resize(short_unicode_sequence_length);
+			return;
+		case 'U':
+			this->cur_state = state::unicode_sequence;
+			this->sequence_index = 0;
+			this->sequence.resize(long_unicode_sequence_length);
+			return;
+		case 'n':
+			this->append_to_string('\n');
+			break;
+		case 't':
+			this->append_to_string('\t');
+			break;
+		case '\n':
+			this->append_to_string('\\');
+			if (this->previous_state == state::unquoted_string) {
+				this->cur_state = state::unquoted_string;
+				this->process_char_in_unquoted_string('\n', listener);
+				return;
+			}
+			break;
+		case '"':
+		case '\\':
+			this->append_to_string(c);
+			break;
+		case ' ':
+		case '{':
+		case '}':
+			if (this->previous_state == state::quoted_string) {
+				this->append_to_string('\\');
+			}
+			this->append_to_string(c);
+			break;
+		default:
+			this->append_to_string('\\');
+			this->append_to_string(c);
+			break;
+	}
+	this->cur_state = this->previous_state;
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_unicode_sequence(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::unicode_sequence)
+
+	this->sequence[this->sequence_index] = c;
+	++this->sequence_index;
+
+	if (this->sequence_index == this->sequence.size()) {
+		uint32_t value = 0;
+		auto span = utki::make_span(this->sequence.data(), this->sequence.size());
+		auto res = std::from_chars(
+			span.data(), //
+			utki::end_pointer(span),
+			value,
+			utki::to_int(utki::integer_base::hex)
+		);
+
+		// all the characters of the sequence have to be hexadecimal digits
+		if (res.ec != std::errc() || res.ptr != utki::end_pointer(span)) {
+			if (this->diagnostics) {
+				this->report(diagnostic_kind::invalid_unicode_escape_sequence);
+
+				// recover by dropping the escape sequence
+				this->cur_state = this->previous_state;
+				this->sequence.clear();
+
+				// in case the escape sequence was the only content of the unquoted string, then there is no string,
+				// unquoted string is only started from idle state, see process_char_in_idle()
+				if (this->cur_state == state::unquoted_string && this->is_string_empty()) {
+					this->cur_state = state::idle;
+				}
+				return;
+			}
+
+			std::stringstream ss;
+			ss << "malformed document: could not parse hexadecimal number of unicode escape sequence at line: "
+			   << this->cur_line;
+			internal::throw_exception(std::invalid_argument(ss.str()));
+		}
+
+		auto bytes = utki::to_utf8(char32_t(value));
+
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+		for (auto b : bytes) {
+			if (b == '\0') {
+				break;
+			}
+			this->append_to_string(b);
+		}
+
+		this->cur_state = this->previous_state;
+		this->sequence.clear();
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_comment_sequence(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::comment_seqence)
+	switch (c) {
+		case '/':
+			this->cur_state = state::single_line_comment;
+			break;
+		case '*':
+			this->cur_state = state::multiline_comment;
+			break;
+		case '{':
+			this->handle_string_parsed(listener);
+			ASSERT(this->is_string_empty(), [this](auto& o) {
+				o << "string = " << utki::make_string(this->get_string());
+			})
+			this->set_string_start_pos();
+			if constexpr (track_extra_info) {
+				--this->info.location.offset;
+				--this->info.location.byte_offset;
+			}
+
+			this->append_to_string('/');
+			this->set_string_parsed_state();
+			this->handle_string_parsed(listener);
+			this->notify_children_parse_started(listener);
+			this->cur_state = state::initial;
+			break;
+		case '\n':
+		case '\r':
+		case '\t':
+		case ' ':
+			if (!this->is_string_empty()) {
+				this->handle_string_parsed(listener);
+			}
+			ASSERT(this->is_string_empty(), [this](auto& o) {
+				o << "string = " << utki::make_string(this->get_string());
+			})
+			this->append_to_string('/');
+			// this->handle_string_parsed(listener);
+			this->set_string_parsed_state();
+			break;
+		case '\0':
+			// single slash at the end of data
+			this->process_char_in_comment_sequence(' ', listener);
+			this->process_char('\0', listener);
+			break;
+		default:
+			if (!this->is_string_empty()) {
+				this->handle_string_parsed(listener);
+			}
+			ASSERT(this->is_string_empty())
+			this->append_to_string('/');
+			this->append_to_string(c);
+			this->cur_state = state::unquoted_string;
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_single_line_comment(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::single_line_comment)
+	this->set_flag<flag::space>(this->info);
+	switch (c) {
+		case '\0':
+			this->cur_state = this->previous_state;
+			this->process_char('\0', listener);
+			break;
+		case '\n':
+			this->cur_state = this->previous_state;
+			break;
+		default:
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_multiline_comment(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::multiline_comment)
+	switch (c) {
+		case '*':
+			// ASSERT(this->buf.size() == 0)
+			// only the last asterisk is needed to detect the comment end,
+			// so the sequence holds at most one, e.g. for '**/'
+			if (this->sequence.empty()) {
+				this->sequence.push_back('*');
+			}
+			break;
+		case '/':
+			if (this->sequence.size() != 0) {
+				ASSERT(this->sequence.size() == 1)
+				ASSERT(this->sequence.back() == '*')
+				this->sequence.clear();
+				this->cur_state = this->previous_state;
+			}
+			break;
+		default:
+			this->sequence.clear();
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_raw_cpp_string_opening_sequence(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::raw_cpp_string_opening_sequence)
+	switch (c) {
+		case '"':
+			// not a C++ style raw string, report 'R' string and a quoted string
+			{
+				char r = 'R';
+				if constexpr (track_extra_info) {
+					this->info.length = 1;
+				}
+				this->notify_string_parsed(std::string_view(&r, 1), this->info, listener);
+				this->clear_flag<flag::space>(this->info);
+			}
+			if constexpr (track_extra_info) {
+				++this->info.location.offset;
+				++this->info.location.byte_offset;
+			}
+
+			if (this->is_string_empty()) {
+				this->cur_state = state::raw_quotes_string_opening_sequence;
+				this->sequence_index = 2; // it is a second double quote in a row
+			} else {
+				this->set_flag<flag::quoted>(this->info);
+				// this->handle_string_parsed(listener);
+				this->set_string_parsed_state();
+			}
+			break;
+		case '(':
+			ASSERT(this->get_sequence().empty())
+			if (this->buf.empty()) {
+				// the delimiter lies within the data chunk, so refer it there instead of copying
+				this->chunk_sequence = this->chunk_string;
+			} else {
+				this->sequence.assign(this->buf);
+			}
+			this->clear_string();
+			this->cur_state = state::raw_cpp_string;
+			this->set_flag<flag::raw>(this->info);
+			break;
+		default:
+			this->append_cur_char_to_string(c);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_raw_cpp_string(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::raw_cpp_string)
+	switch (c) {
+		case ')':
+			this->sequence_index = 0;
+			this->cur_state = state::raw_cpp_string_closing_sequence;
+			break;
+		default:
+			this->append_cur_char_to_string(c);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_raw_cpp_string_closing_sequence(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::raw_cpp_string_closing_sequence)
+	auto delimiter = this->get_sequence();
+	switch (c) {
+		case '"':
+			ASSERT(this->sequence_index <= delimiter.size())
+			if (this->sequence_index != delimiter.size()) {
+				this->append_to_string(')');
+				for (size_t i = 0; i != this->sequence_index; ++i) {
+					this->append_to_string(delimiter[i]);
+				}
+				this->cur_state = state::raw_cpp_string;
+			} else {
+				this->clear_sequence();
+				// this->handle_string_parsed(listener);
+				this->set_string_parsed_state();
+			}
+			break;
+		default:
+			ASSERT(this->sequence_index <= delimiter.size())
+			if (this->sequence_index == delimiter.size() || c != delimiter[this->sequence_index]) {
+				this->append_to_string(')');
+				for (size_t i = 0; i != this->sequence_index; ++i) {
+					this->append_to_string(delimiter[i]);
+				}
+				this->cur_state = state::raw_cpp_string;
+			} else {
+				++this->sequence_index;
+			}
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_raw_quotes_string_opening_sequence(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::raw_quotes_string_opening_sequence)
+	ASSERT(this->is_string_empty())
+	switch (c) {
+		case '"':
+			++this->sequence_index;
+			if (this->sequence_index == 3) {
+				this->cur_state = state::raw_quotes_string;
+				this->set_flag<flag::raw>(this->info);
+				this->set_flag<flag::raw_quotes_style>(this->info);
+			}
+			break;
+		default:
+			this->set_flag<flag::quoted>(this->info);
+			switch (this->sequence_index) {
+				default:
+					ASSERT(false)
+				case 1:
+					this->cur_state = state::quoted_string;
+					this->process_char_in_quoted_string(c, listener);
+					break;
+				case 2:
+					// empty quoted string
+					// this->handle_string_parsed(listener);
+					this->set_string_parsed_state();
+					this->process_char_in_string_parsed(c, listener);
+					break;
+			}
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_raw_quotes_string(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::raw_quotes_string)
+	switch (c) {
+		case '"':
+			this->cur_state = state::raw_quotes_string_closing_sequence;
+			this->sequence_index = 1;
+			break;
+		default:
+			this->append_cur_char_to_string(c);
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char_in_raw_quotes_string_closing_sequence(char c, listener_type& listener)
+{
+	ASSERT(this->cur_state == state::raw_quotes_string_closing_sequence)
+	switch (c) {
+		case '"':
+			++this->sequence_index;
+			if (this->sequence_index == 3) {
+				// this->handle_string_parsed(listener);
+				this->set_string_parsed_state();
+			}
+			break;
+		default:
+			for (size_t i = 0; i != this->sequence_index; ++i) {
+				this->append_to_string('"');
+			}
+			this->append_to_string(c);
+			this->cur_state = state::raw_quotes_string;
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::process_char(char c, listener_type& listener)
+{
+	switch (this->cur_state) {
+		case state::initial:
+			this->process_char_in_initial(c, listener);
+			break;
+		case state::idle:
+			this->process_char_in_idle(c, listener);
+			break;
+		case state::string_parsed:
+			this->process_char_in_string_parsed(c, listener);
+			break;
+		case state::unquoted_string:
+			this->process_char_in_unquoted_string(c, listener);
+			break;
+		case state::quoted_string:
+			this->process_char_in_quoted_string(c, listener);
+			break;
+		case state::escape_sequence:
+			this->process_char_in_escape_sequence(c, listener);
+			break;
+		case state::unicode_sequence:
+			this->process_char_in_unicode_sequence(c, listener);
+			break;
+		case state::comment_seqence:
+			this->process_char_in_comment_sequence(c, listener);
+			break;
+		case state::single_line_comment:
+			this->process_char_in_single_line_comment(c, listener);
+			break;
+		case state::multiline_comment:
+			this->process_char_in_multiline_comment(c, listener);
+			break;
+		case state::raw_cpp_string_opening_sequence:
+			this->process_char_in_raw_cpp_string_opening_sequence(c, listener);
+			break;
+		case state::raw_cpp_string:
+			this->process_char_in_raw_cpp_string(c, listener);
+			break;
+		case state::raw_cpp_string_closing_sequence:
+			this->process_char_in_raw_cpp_string_closing_sequence(c, listener);
+			break;
+		case state::raw_quotes_string_opening_sequence:
+			this->process_char_in_raw_quotes_string_opening_sequence(c, listener);
+			break;
+		case state::raw_quotes_string:
+			this->process_char_in_raw_quotes_string(c, listener);
+			break;
+		case state::raw_quotes_string_closing_sequence:
+			this->process_char_in_raw_quotes_string_closing_sequence(c, listener);
+			break;
+		default:
+			ASSERT(false, [&](auto& o) {
+				o << "this->cur_state = " << unsigned(this->cur_state);
+			})
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+bool basic_parser<listener_type, track_extra_info>::consumes_plain_chars() const noexcept
+{
+	switch (this->cur_state) {
+		case state::unquoted_string:
+		case state::quoted_string:
+		case state::raw_cpp_string:
+		case state::raw_quotes_string:
+		case state::single_line_comment:
+		case state::multiline_comment:
+			return true;
+		default:
+			return false;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+bool basic_parser<listener_type, track_extra_info>::is_special_char(char c) const noexcept
+{
+	// For each state, the special characters are the ones which are handled specially by the state's
+	// process_char_in_*() function, plus the new line character which is needed for tracking the current line.
+	// All these characters must be in the set of structural characters, see internal::index_structural_chars().
+	switch (this->cur_state) {
+		case state::unquoted_string:
+			return internal::is_any_of<'\0', '\t', '\n', '\r', ' ', '"', '\\', '{', '}'>(c);
+		case state::quoted_string:
+			return internal::is_any_of<'\t', '\n', '\r', '"', '\\'>(c);
+		case state::raw_cpp_string:
+			return internal::is_any_of<'\n', ')'>(c);
+		case state::raw_quotes_string:
+			return internal::is_any_of<'\n', '"'>(c);
+		case state::single_line_comment:
+			return internal::is_any_of<'\0', '\n'>(c);
+		case state::multiline_comment:
+			return internal::is_any_of<'\n', '*', '/'>(c);
+		default:
+			return true;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::consume_plain_chars(utki::span<const char> run)
+{
+	if (run.empty()) {
+		return;
+	}
+
+	switch (this->cur_state) {
+		case state::unquoted_string:
+		case state::quoted_string:
+		case state::raw_cpp_string:
+		case state::raw_quotes_string:
+			this->append_to_string(run);
+			break;
+		case state::single_line_comment:
+			this->set_flag<flag::space>(this->info);
+			break;
+		case state::multiline_comment:
+			this->sequence.clear();
+			break;
+		default:
+			ASSERT(false)
+			break;
+	}
+
+	this->advance_offset(run.size());
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::parse_indexed_window(
+	utki::span<const char> window, //
+	utki::span<const uint64_t> index,
+	listener_type& listener
+)
+{
+	for (size_t pos = 0; pos != window.size(); ++pos) {
+		if (this->consumes_plain_chars()) {
+			// all characters up to the next structural one are plain, structural characters
+			// which are not special in the current state are plain as well
+			size_t end = internal::find_next_structural_char(index, pos, window.size());
+			while (end != window.size() && !this->is_special_char(window[end])) {
+				end = internal::find_next_structural_char(index, end + 1, window.size());
+			}
+
+			this->consume_plain_chars(window.subspan(pos, end - pos));
+
+			pos = end;
+			if (pos == window.size()) {
+				break;
+			}
+		}
+
+		this->cur_char = window.subspan(pos, 1);
+
+		auto c = window[pos];
+		if (c == '\n') {
+			this->next_line();
+		}
+		this->process_char(c, listener);
+		this->advance_offset(1);
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::parse_data_chunk(utki::span<const char> chunk, listener_type& listener)
+{
+	this->parse_data_chunk_in_place(chunk, listener);
+
+	// the chunk data will not be available after returning from this function,
+	// so copy the unfinished string and the raw string delimiter to the buffers
+	this->release_chunk();
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::parse_data_chunk_in_place(
+	utki::span<const char> chunk, //
+	listener_type& listener
+)
+{
+	// The chunk is parsed in two stages, window by window.
+	// First stage builds the index of structural characters of the window using SIMD instructions if available.
+	// Second stage runs the state machine, using the index to skip over the characters which
+	// need no special handling in the current state.
+	constexpr size_t window_num_blocks = 0x400;
+	std::array<uint64_t, window_num_blocks> index; // NOLINT(cppcoreguidelines-pro-type-member-init)
+
+	while (!chunk.empty()) {
+		auto window = chunk.subspan(0, std::min(chunk.size(), window_num_blocks * internal::index_block_size));
+
+		internal::index_structural_chars(window, utki::make_span(index));
+
+		this->parse_indexed_window(window, utki::make_span(index), listener);
+
+		chunk = chunk.subspan(window.size());
+	}
+
+	this->cur_char = {};
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::end_of_data(listener_type& listener)
+{
+	if (this->diagnostics) {
+		this->recover_unterminated_token();
+	}
+
+	this->process_char('\0', listener);
+
+	if (this->nesting_level != 0) {
+		if (!this->diagnostics) {
+			internal::throw_exception(std::invalid_argument(
+				"Malformed tml document fed. Document end reached while parsing children block."
+			));
+		}
+
+		// recover by closing the children lists
+		while (this->nesting_level != 0) {
+			this->report(diagnostic_kind::unclosed_children_list);
+			this->notify_children_parse_finished(listener);
+		}
+	}
+
+	if (this->cur_state != state::idle) {
+		ASSERT(!this->diagnostics)
+		internal::throw_exception(std::invalid_argument(
+			"Malformed tml document fed. After parsing all the data, the parser remained in the middle of some parsing task."
+		));
+	}
+
+	this->reset();
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::report(diagnostic_kind kind)
+{
+	ASSERT(this->diagnostics)
+	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+	this->diagnostics->report({kind, this->get_cur_loc()});
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::recover_unterminated_token()
+{
+	if ((this->cur_state == state::escape_sequence || this->cur_state == state::unicode_sequence) &&
+		this->previous_state == state::unquoted_string && this->is_string_empty())
+	{
+		// the unterminated escape sequence is the only content of the unquoted string, so there is no string
+		this->report(diagnostic_kind::unterminated_string);
+		this->sequence.clear();
+		this->cur_state = state::idle;
+		return;
+	}
+
+	switch (this->cur_state) {
+		case state::raw_quotes_string_opening_sequence:
+			if (this->sequence_index != 1) {
+				// empty quoted string, it is complete
+				break;
+			}
+			// single double quote, i.e. unterminated quoted string
+			[[fallthrough]];
+		case state::quoted_string:
+		case state::escape_sequence:
+		case state::unicode_sequence:
+		case state::raw_cpp_string_opening_sequence:
+		case state::raw_cpp_string:
+		case state::raw_cpp_string_closing_sequence:
+		case state::raw_quotes_string:
+		case state::raw_quotes_string_closing_sequence:
+			this->report(diagnostic_kind::unterminated_string);
+
+			// recover by terminating the string at the end of data,
+			// there is no closing quote, so the token length is computed as for unquoted string
+			this->cur_state = state::unquoted_string;
+			this->set_string_parsed_state();
+			break;
+		case state::multiline_comment:
+			this->report(diagnostic_kind::unterminated_comment);
+			this->cur_state = this->previous_state;
+			break;
+		default:
+			break;
+	}
+}
+
+template <typename listener_type, bool track_extra_info>
+parser_snapshot basic_parser<listener_type, track_extra_info>::snapshot() const
+{
+	ASSERT(this->cur_char.empty())
+
+	parser_snapshot ret;
+
+	ret.string = utki::make_string_view(this->get_string());
+	ret.sequence = utki::make_string_view(this->get_sequence());
+	ret.sequence_index = this->sequence_index;
+	ret.nesting_level = this->nesting_level;
+	ret.skip_depth = this->skip_depth;
+	ret.cur_state = unsigned(this->cur_state);
+	ret.previous_state = unsigned(this->previous_state);
+	ret.cur_line = this->cur_line;
+	ret.cur_line_start = this->cur_line_start;
+	ret.cur_byte_offset = this->cur_byte_offset;
+	ret.info = this->info;
+	ret.string_parsed_info = this->string_parsed_info;
+
+	return ret;
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::restore(const parser_snapshot& s)
+{
+	constexpr auto max_state = unsigned(state::raw_quotes_string);
+	if (s.cur_state > max_state || s.previous_state > max_state) {
+		internal::throw_exception(std::invalid_argument("tml::parser::restore(): invalid parser state in snapshot"));
+	}
+	if (s.skip_depth > s.nesting_level) {
+		internal::throw_exception(std::invalid_argument(
+			"tml::parser::restore(): skip depth exceeds nesting level in snapshot"
+		));
+	}
+	if (s.cur_line == 0 || s.cur_line_start > s.cur_byte_offset) {
+		internal::throw_exception(std::invalid_argument("tml::parser::restore(): invalid position in snapshot"));
+	}
+
+	// the escape sequences and the comments return to the previous state, check that it is the one they start from
+	bool uses_previous_state = false;
+	bool valid_previous_state = true;
+	switch (state(s.cur_state)) {
+		case state::escape_sequence:
+		case state::unicode_sequence:
+			uses_previous_state = true;
+			valid_previous_state = state(s.previous_state) == state::quoted_string ||
+				state(s.previous_state) == state::unquoted_string;
+			break;
+		case state::comment_seqence:
+		case state::single_line_comment:
+		case state::multiline_comment:
+			uses_previous_state = true;
+			valid_previous_state = state(s.previous_state) == state::initial || state(s.previous_state) == state::idle ||
+				state(s.previous_state) == state::string_parsed;
+			break;
+		default:
+			break;
+	}
+	if (!valid_previous_state) {
+		internal::throw_exception(std::invalid_argument(
+			"tml::parser::restore(): previous state does not match parser state in snapshot"
+		));
+	}
+
+	// check the sequence and the string against the state which uses them
+	auto is_valid_for = [&s](state st) {
+		switch (st) {
+			case state::initial:
+			case state::idle:
+				return s.string.empty();
+			case state::unicode_sequence:
+				return s.sequence_index < s.sequence.size() &&
+					(s.sequence.size() == short_unicode_sequence_length ||
+					 s.sequence.size() == long_unicode_sequence_length);
+			case state::comment_seqence:
+				return s.sequence.empty();
+			case state::multiline_comment:
+				return s.sequence.empty() || s.sequence == "*";
+			case state::raw_cpp_string_opening_sequence:
+				// the delimiter is collected to the string
+				return s.sequence.empty();
+			case state::raw_cpp_string_closing_sequence:
+				return s.sequence_index <= s.sequence.size();
+			case state::raw_quotes_string_opening_sequence:
+				return s.string.empty() && (s.sequence_index == 1 || s.sequence_index == 2);
+			case state::raw_quotes_string_closing_sequence:
+				return s.sequence_index == 1 || s.sequence_index == 2;
+			default:
+				return true;
+		}
+	};
+	if (!is_valid_for(state(s.cur_state)) || (uses_previous_state && !is_valid_for(state(s.previous_state)))) {
+		internal::throw_exception(std::invalid_argument(
+			"tml::parser::restore(): sequence does not match parser state in snapshot"
+		));
+	}
+
+	this->clear_string();
+	this->buf.assign(s.string.begin(), s.string.end());
+	this->cur_char = {};
+	this->clear_sequence();
+	this->sequence.assign(s.sequence);
+	this->sequence_index = s.sequence_index;
+	this->nesting_level = s.nesting_level;
+	this->skip_depth = s.skip_depth;
+	this->cur_state = state(s.cur_state);
+	this->previous_state = state(s.previous_state);
+	this->cur_line = s.cur_line;
+	this->cur_line_start = s.cur_line_start;
+	this->cur_byte_offset = s.cur_byte_offset;
+	this->info = s.info;
+	this->string_parsed_info = s.string_parsed_info;
+}
+
+template <typename listener_type, bool track_extra_info>
+void basic_parser<listener_type, track_extra_info>::reset()
+{
+	// the diagnostics sink is not a part of the parsing state, so it is kept
+	this->clear_string();
+	this->cur_char = {};
+	this->clear_sequence();
+	this->sequence_index = 0;
+	this->nesting_level = 0;
+	this->skip_depth = 0;
+	this->cur_state = state::initial;
+	this->previous_state = state::idle;
+	this->cur_line = 1;
+	this->cur_line_start = 0;
+	this->cur_byte_offset = 0;
+	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+	this->info = {{}, tml::flag::first_on_line};
+	this->string_parsed_info = {};
+}
+
+/**
+ * @brief tml parser working with tml::listener interface.
+ */
+using parser = basic_parser<listener>;
+
+extern template class basic_parser<listener>;
+
+/**
+ * @brief Default size of data chunks read from file by tml::parse().
+ */
+constexpr size_t default_file_read_chunk_size = 0x10000;
+
+namespace internal {
+
+template <typename listener_type>
+void parse(
+	const fsif::file& fi, //
+	listener_type& listener,
+	size_t chunk_size
+)
+{
+	if (chunk_size == 0) {
+		internal::throw_exception(std::invalid_argument("tml::parse(): chunk_size is 0"));
+	}
+
+	fsif::file::guard file_guard(fi);
+
+	basic_parser<listener_type> parser;
+
+	std::vector<uint8_t> buf(chunk_size);
+
+	for (;;) {
+		size_t num_bytes_read = fi.read(utki::make_span(buf));
+
+		parser.parse_data_chunk(utki::make_span(buf.data(), num_bytes_read), listener);
+
+		if (num_bytes_read != buf.size()) {
+			break;
+		}
+	}
+
+	parser.end_of_data(listener);
+}
+
+template <typename listener_type>
+void parse(utki::span<const char> data, listener_type& listener)
+{
+	basic_parser<listener_type> parser;
+
+	parser.parse_data_chunk(data, listener);
+
+	parser.end_of_data(listener);
+}
+
+template <typename listener_type>
+void parse_mapped(const std::string& path, listener_type& listener)
+{
+	{
+		const file_mapping mapping(path);
+		if (mapping.is_mapped()) {
+			internal::parse(mapping.data(), listener);
+			return;
+		}
+	}
+
+	internal::parse(fsif::native_file(path), listener, default_file_read_chunk_size);
+}
+
+// Functions templated by listener type are only enabled for listeners which do not implement tml::listener
+// interface. For tml::listener implementations the non-template functions are used.
+template <typename listener_type>
+using enable_if_static_listener_t = std::enable_if_t<!std::is_base_of_v<tml::listener, listener_type>, bool>;
+
+} // namespace internal
+
 /**
  * @brief Parse tml document provided by given file interface.
  * Use this function to parse the tml document from file.
+ * The file data is read and parsed chunk by chunk.
+ * @param fi - file interface to use for getting the data to parse.
+ * @param listener - listener object which will receive notifications about parsed tokens.
+ * @param chunk_size - size of data chunks to read from the file.
+ */
+void parse(
+	const fsif::file& fi, //
+	listener& listener,
+	size_t chunk_size = default_file_read_chunk_size
+);
+
+/**
+ * @brief Parse tml document provided by given file interface.
+ * Same as tml::parse(const fsif::file&, listener&, size_t), but the listener
+ * methods are called directly, without virtual dispatch.
  * @param fi - file interface to use for getting the data to parse.
  * @param listener - listener object which will receive notifications about parsed tokens.
+ * @param chunk_size - size of data chunks to read from the file.
+ */
+template <typename listener_type, internal::enable_if_static_listener_t<listener_type> = true>
+void parse(
+	const fsif::file& fi, //
+	listener_type& listener,
+	size_t chunk_size = default_file_read_chunk_size
+)
+{
+	internal::parse(fi, listener, chunk_size);
+}
+
+/**
+ * @brief Parse tml document residing in memory.
+ * The whole document is parsed as a single data chunk.
+ * @param data - the tml document.
+ * @param listener - listener object which will receive notifications about parsed tokens.
+ */
+void parse(utki::span<const char> data, listener& listener);
+
+/**
+ * @brief Parse tml document residing in memory.
+ * Same as tml::parse(utki::span<const char>, listener&), but the listener
+ * methods are called directly, without virtual dispatch.
+ * @param data - the tml document.
+ * @param listener - listener object which will receive notifications about parsed tokens.
  */
-void parse(const fsif::file& fi, listener& listener);
+template <typename listener_type, internal::enable_if_static_listener_t<listener_type> = true>
+void parse(utki::span<const char> data, listener_type& listener)
+{
+	internal::parse(data, listener);
+}
+
+/**
+ * @brief Parse tml document from file system file.
+ * On platforms which support it, the file is memory-mapped and the whole file contents
+ * is parsed as a single data chunk. In case the file cannot be mapped, e.g. it is not a regular file,
+ * or on other platforms, the file is read by chunks via fsif::native_file.
+ * @param path - path to the file.
+ * @param listener - listener object which will receive notifications about parsed tokens.
+ */
+void parse_mapped(const std::string& path, listener& listener);
+
+/**
+ * @brief Parse tml document from file system file.
+ * Same as tml::parse_mapped(const std::string&, listener&), but the listener
+ * methods are called directly, without virtual dispatch.
+ * @param path - path to the file.
+ * @param listener - listener object which will receive notifications about parsed tokens.
+ */
+template <typename listener_type, internal::enable_if_static_listener_t<listener_type> = true>
+void parse_mapped(const std::string& path, listener_type& listener)
+{
+	internal::parse_mapped(path, listener);
+}
 
 } // namespace tml
@@ -0,0 +1,156 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#include "reader.hpp"
+
+#include <functional>
+
+using namespace tml;
+
+void reader::event_collector::on_string_parsed(std::string_view str, const extra_info& info)
+{
+	auto sp = utki::make_span(str);
+
+	// The string may point to the parser's buffer, i.e. outside of the chunk, and built-in comparison of pointers to
+	// different arrays is unspecified, while std::less_equal gives total order.
+	std::less_equal<const char*> le;
+	if (!sp.empty() && le(this->chunk.data(), sp.data()) && le(utki::end_pointer(sp), utki::end_pointer(this->chunk))) {
+		// the string refers to the data chunk, which remains valid until all the queued events are consumed
+		this->events.push_back({
+			{event_type::string, str, info}
+		});
+		return;
+	}
+
+	// the string refers to the parser's internal buffer, which can change while parsing
+	// the rest of the chunk, so copy the string
+	this->events.push_back({
+		{event_type::string, {}, info},
+		true,
+		this->pool.size(),
+		str.size()
+	});
+	this->pool.append(str);
+}
+
+void reader::event_collector::on_children_parse_started(location loc)
+{
+	this->events.push_back({
+		{event_type::children_begin, {}, {loc, {}}}
+	});
+}
+
+void reader::event_collector::on_children_parse_finished(location loc)
+{
+	this->events.push_back({
+		{event_type::children_end, {}, {loc, {}}}
+	});
+}
+
+reader::reader(utki::span<const char> data, size_t chunk_size) :
+	data(data),
+	chunk_size(chunk_size)
+{
+	if (chunk_size == 0) {
+		internal::throw_exception(std::invalid_argument("tml::reader::reader(): chunk_size is 0"));
+	}
+}
+
+reader::reader(const fsif::file& fi, size_t chunk_size) :
+	fi(&fi),
+	buffer(chunk_size),
+	chunk_size(chunk_size)
+{
+	if (chunk_size == 0) {
+		internal::throw_exception(std::invalid_argument("tml::reader::reader(): chunk_size is 0"));
+	}
+	fi.open();
+}
+
+reader::~reader()
+{
+	if (this->fi) {
+		this->fi->close();
+	}
+}
+
+void reader::parse_next_chunk()
+{
+	ASSERT(!this->end_reached)
+
+	utki::span<const char> chunk;
+
+	if (this->fi) {
+		auto num_bytes_read = this->fi->read(utki::to_uint8_t(utki::make_span(this->buffer)));
+		chunk = utki::make_span(this->buffer.data(), num_bytes_read);
+	} else {
+		chunk = this->data.subspan(0, std::min(this->chunk_size, this->data.size()));
+		this->data = this->data.subspan(chunk.size());
+	}
+
+	this->collector.chunk = chunk;
+
+	if (chunk.empty()) {
+		this->end_reached = true;
+		this->parser.end_of_data(this->collector);
+		this->collector.events.push_back({
+			{event_type::end, {}, {}}
+		});
+		return;
+	}
+
+	this->parser.parse_data_chunk(chunk, this->collector);
+}
+
+const reader::event& reader::next()
+{
+	auto& events = this->collector.events;
+
+	if (this->next_event_index == events.size()) {
+		events.clear();
+		this->collector.pool.clear();
+		this->next_event_index = 0;
+
+		while (events.empty()) {
+			if (this->end_reached) {
+				this->cur_event = {event_type::end, {}, {}};
+				return this->cur_event;
+			}
+			this->parse_next_chunk();
+		}
+	}
+
+	const auto& qe = events[this->next_event_index];
+	++this->next_event_index;
+
+	this->cur_event = qe.e;
+	if (qe.in_pool) {
+		this->cur_event.string = std::string_view(this->collector.pool).substr(qe.pool_offset, qe.pool_length);
+	}
+
+	return this->cur_event;
+}
@@ -0,0 +1,172 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fsif/file.hpp>
+#include <utki/span.hpp>
+
+#include "extra_info.hpp"
+#include "parser.hpp"
+
+namespace tml {
+
+/**
+ * @brief Pull-style tml reader.
+ * Instead of pushing the parsed tokens to a listener, the reader returns them one by one
+ * on each call to next(). The input data is parsed in small portions as the events are requested,
+ * so the consumer can stop reading at any point without paying for parsing the rest of the document.
+ */
+class reader
+{
+public:
+	enum class event_type {
+		/**
+		 * @brief String node parsed.
+		 */
+		string,
+
+		/**
+		 * @brief Children list of the last parsed node started.
+		 */
+		children_begin,
+
+		/**
+		 * @brief Children list ended.
+		 */
+		children_end,
+
+		/**
+		 * @brief End of the document reached.
+		 */
+		end
+	};
+
+	struct event {
+		event_type type;
+
+		/**
+		 * @brief Parsed string.
+		 * Only valid for the string events, until the next call to reader::next().
+		 */
+		std::string_view string;
+
+		/**
+		 * @brief Extra information of the parsed string.
+		 * For the children_begin and children_end events only the location is valid.
+		 */
+		extra_info info;
+	};
+
+	/**
+	 * @brief Size of the data portions to parse at a time.
+	 */
+	constexpr static size_t default_chunk_size = 0x1000;
+
+private:
+	// parser listener which collects the events to the queue
+	class event_collector
+	{
+		friend class reader;
+
+		// the strings which do not refer to the data chunk being parsed are copied to the string pool
+		struct queued_event {
+			event e;
+			bool in_pool = false;
+			size_t pool_offset = 0;
+			size_t pool_length = 0;
+		};
+
+		std::vector<queued_event> events;
+		std::string pool;
+
+		utki::span<const char> chunk;
+
+	public:
+		void on_string_parsed(std::string_view str, const extra_info& info);
+		void on_children_parse_started(location loc);
+		void on_children_parse_finished(location loc);
+	} collector;
+
+	basic_parser<event_collector> parser;
+
+	size_t next_event_index = 0;
+
+	event cur_event = {event_type::end, {}, {}};
+
+	bool end_reached = false;
+
+	// input data when reading from memory
+	utki::span<const char> data;
+
+	// input file when reading from file
+	const fsif::file* fi = nullptr;
+	std::vector<char> buffer;
+
+	size_t chunk_size;
+
+	void parse_next_chunk();
+
+public:
+	/**
+	 * @brief Construct reader of tml document residing in memory.
+	 * The data must remain valid during the reader lifetime.
+	 * @param data - the tml document.
+	 * @param chunk_size - size of data portions to parse at a time.
+	 */
+	reader(utki::span<const char> data, size_t chunk_size = default_chunk_size);
+
+	/**
+	 * @brief Construct reader of tml document provided by file interface.
+	 * The file is opened by the reader and closed on the reader destruction.
+	 * The file interface object must remain valid during the reader lifetime.
+	 * @param fi - file interface to read the document from.
+	 * @param chunk_size - size of data portions to read from the file and parse at a time.
+	 */
+	reader(const fsif::file& fi, size_t chunk_size = default_chunk_size);
+
+	reader(const reader&) = delete;
+	reader& operator=(const reader&) = delete;
+
+	reader(reader&&) = delete;
+	reader& operator=(reader&&) = delete;
+
+	~reader();
+
+	/**
+	 * @brief Get next event.
+	 * After the end event is returned, all subsequent calls return the end event as well.
+	 * @return The next event.
+	 */
+	const event& next();
+};
+
+} // namespace tml
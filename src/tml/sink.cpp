@@ -0,0 +1,85 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#include "sink.hpp"
+
+#include <stdexcept>
+
+#include "exception.hpp"
+
+using namespace tml;
+
+buffered_sink::buffered_sink(sink& destination, size_t buffer_size) :
+	destination(destination),
+	buffer([&]() {
+		if (buffer_size == 0) {
+			internal::throw_exception(std::invalid_argument("buffered_sink::buffered_sink(): buffer_size is 0"));
+		}
+		return buffer_size;
+	}())
+{}
+
+void buffered_sink::write(utki::span<const char> data)
+{
+	if (this->buffer.size() - this->num_buffered < data.size()) {
+		this->flush();
+
+		if (data.size() >= this->buffer.size()) {
+			// the data does not fit into the buffer, write it directly
+			this->destination.write(data);
+			return;
+		}
+	}
+
+	std::copy(data.begin(), data.end(), std::next(this->buffer.begin(), ptrdiff_t(this->num_buffered)));
+	this->num_buffered += data.size();
+}
+
+void buffered_sink::write(char c, size_t count)
+{
+	while (count != 0) {
+		if (this->num_buffered == this->buffer.size()) {
+			this->flush();
+		}
+
+		auto n = std::min(count, this->buffer.size() - this->num_buffered);
+		auto begin = std::next(this->buffer.begin(), ptrdiff_t(this->num_buffered));
+		std::fill(begin, std::next(begin, ptrdiff_t(n)), c);
+
+		this->num_buffered += n;
+		count -= n;
+	}
+}
+
+void buffered_sink::flush()
+{
+	if (this->num_buffered == 0) {
+		return;
+	}
+	this->destination.write(utki::make_span(this->buffer.data(), this->num_buffered));
+	this->num_buffered = 0;
+}
@@ -0,0 +1,168 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <fsif/file.hpp>
+#include <utki/debug.hpp>
+#include <utki/span.hpp>
+
+namespace tml {
+
+/**
+ * @brief Output data sink interface.
+ */
+class sink
+{
+public:
+	sink() = default;
+
+	sink(const sink&) = default;
+	sink& operator=(const sink&) = default;
+
+	sink(sink&&) = default;
+	sink& operator=(sink&&) = default;
+
+	virtual ~sink() = default;
+
+	/**
+	 * @brief Write data to the sink.
+	 * @param data - data to write.
+	 */
+	virtual void write(utki::span<const char> data) = 0;
+};
+
+/**
+ * @brief Sink writing to a file interface.
+ * The file must be opened for writing.
+ */
+class file_sink : public sink
+{
+	fsif::file& fi;
+
+public:
+	file_sink(fsif::file& fi) :
+		fi(fi)
+	{}
+
+	void write(utki::span<const char> data) override
+	{
+		this->fi.write(data);
+	}
+};
+
+/**
+ * @brief Sink writing to a standard output stream.
+ */
+class ostream_sink : public sink
+{
+	std::ostream& o;
+
+public:
+	ostream_sink(std::ostream& o) :
+		o(o)
+	{}
+
+	void write(utki::span<const char> data) override
+	{
+		this->o.write(data.data(), std::streamsize(data.size()));
+	}
+};
+
+/**
+ * @brief Sink appending to a string.
+ */
+class string_sink : public sink
+{
+public:
+	std::string str;
+
+	void write(utki::span<const char> data) override
+	{
+		this->str.append(data.data(), data.size());
+	}
+};
+
+/**
+ * @brief Buffered sink.
+ * Accumulates written data in a buffer and writes it to the destination sink in big blocks.
+ * Note, that the buffered data is not flushed on destruction, flush() has to be called explicitly.
+ */
+class buffered_sink : public sink
+{
+	sink& destination;
+
+	std::vector<char> buffer;
+	size_t num_buffered = 0;
+
+public:
+	/**
+	 * @brief Default buffer size.
+	 */
+	constexpr static size_t default_buffer_size = 0x10000;
+
+	/**
+	 * @brief Constructor.
+	 * @param destination - sink to write the buffered data to.
+	 * @param buffer_size - size of the buffer, must not be 0.
+	 */
+	buffered_sink(sink& destination, size_t buffer_size = default_buffer_size);
+
+	void write(utki::span<const char> data) override;
+
+	/**
+	 * @brief Write single character.
+	 * @param c - character to write.
+	 */
+	void write(char c)
+	{
+		if (this->num_buffered == this->buffer.size()) {
+			this->flush();
+		}
+		this->buffer[this->num_buffered] = c;
+		++this->num_buffered;
+	}
+
+	/**
+	 * @brief Write repeated character.
+	 * @param c - character to write.
+	 * @param count - number of times to write the character.
+	 */
+	void write(char c, size_t count);
+
+	/**
+	 * @brief Write all buffered data to the destination sink.
+	 */
+	void flush();
+};
+
+} // namespace tml
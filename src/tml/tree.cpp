@@ -26,260 +26,379 @@ SOFTWARE.
 
 #include "tree.hpp"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
-#include <stack>
+#include <iterator>
+#include <thread>
 
-#include <fsif/span_file.hpp>
-#include <fsif/vector_file.hpp>
 #include <utki/string.hpp>
 
+#include "forest_builder.hpp"
 #include "parser.hpp"
+#include "sink.hpp"
+#include "writer.hpp"
 
 using namespace tml;
 
-forest tml::read(const fsif::file& fi)
+namespace {
+class read_listener : public internal::forest_builder<forest>
 {
-	class the_listener : public tml::listener
+public:
+	constexpr static bool needs_extra_info = false;
+
+	void on_string_parsed(std::string&& str, const extra_info&)
 	{
-		std::stack<forest> stack;
+		this->cur_forest.emplace_back(std::move(str));
+	}
+};
+} // namespace
 
-	public:
-		forest cur_forest;
+forest tml::read(const fsif::file& fi)
+{
+	read_listener listener;
 
-		void on_children_parse_started(location) override
-		{
-			this->stack.push(std::move(this->cur_forest));
-			utki::assert(this->cur_forest.size() == 0, SL);
-		}
+	tml::parse(fi, listener);
 
-		void on_children_parse_finished(location loc) override
-		{
-			if (this->stack.size() == 0) {
-				std::stringstream ss;
-				ss << "malformed tml: unopened curly brace encountered at ";
-				ss << loc.line << ":" << loc.offset;
-				throw std::invalid_argument(ss.str());
-			}
-			this->stack.top().back().children = std::move(this->cur_forest);
-			this->cur_forest = std::move(this->stack.top());
-			this->stack.pop();
-		}
+	return std::move(listener.cur_forest);
+}
 
-		void on_string_parsed(std::string_view str, const extra_info&) override
-		{
-			this->cur_forest.emplace_back(str);
-		}
-	} listener;
+forest tml::read(std::string_view str)
+{
+	read_listener listener;
 
-	tml::parse(fi, listener);
+	tml::parse(utki::make_span(str), listener);
 
 	return std::move(listener.cur_forest);
 }
 
-forest tml::read(std::string_view str)
+forest tml::read(std::string_view str, diagnostics_sink& diagnostics)
 {
-	const fsif::span_file fi(to_uint8_t(utki::make_span(str)));
+	read_listener listener;
 
-	return read(fi);
+	basic_parser<read_listener> parser;
+	parser.set_diagnostics_sink(&diagnostics);
+
+	parser.parse_data_chunk(utki::make_span(str), listener);
+	parser.end_of_data(listener);
+
+	return std::move(listener.cur_forest);
 }
 
 namespace {
-bool can_string_be_unquoted(std::string_view str, size_t& out_length, unsigned& out_num_escapes)
+// Remembers the first reported problem of the document.
+class first_diagnostic_sink : public diagnostics_sink
 {
-	out_num_escapes = 0;
-	out_length = 0;
+public:
+	std::optional<diagnostic> first;
 
-	if (str.empty()) {
-		// empty string cannot be unquoted
-		return false;
+	void report(const diagnostic& d) override
+	{
+		if (!this->first.has_value()) {
+			this->first = d;
+		}
 	}
+};
+} // namespace
 
-	bool ret = true;
+read_result tml::try_read(std::string_view str)
+{
+	first_diagnostic_sink diagnostics;
 
-	for (const auto c : str) {
-		switch (c) {
-			case '\t':
-			case '\n':
-			case '\\':
-			case '"':
-				++out_num_escapes;
-			case '{':
-			case '}':
-			case ' ':
-				ret = false;
-				break;
-			default:
-				break;
-		}
-		++out_length;
+	auto wood = tml::read(str, diagnostics);
+
+	if (diagnostics.first.has_value()) {
+		return {{}, diagnostics.first};
 	}
-	return ret;
+
+	return {std::move(wood), {}};
 }
 
-void make_escaped_string(
-	std::string_view str, //
-	utki::span<uint8_t> out
-)
+namespace {
+// Counts nodes of each children list, the lists are numbered in order of their opening.
+class counting_listener
+{
+	// numbers of the children lists being parsed, the top level list is number 0
+	std::vector<size_t> open_lists = {0};
+
+public:
+	constexpr static bool needs_extra_info = false;
+
+	std::vector<size_t> counts = {0};
+
+	void on_children_parse_started(location)
+	{
+		this->open_lists.push_back(this->counts.size());
+		this->counts.push_back(0);
+	}
+
+	void on_children_parse_finished(location)
+	{
+		ASSERT(this->open_lists.size() > 1)
+		this->open_lists.pop_back();
+	}
+
+	void on_string_parsed(std::string_view, const extra_info&)
+	{
+		++this->counts[this->open_lists.back()];
+	}
+};
+
+// Builds the forest reserving the exact memory for each node list according to the counts.
+class presized_read_listener
+{
+	const std::vector<size_t>& counts;
+	size_t next_list = 1;
+
+	// The node lists are never reallocated, so the pointers to the lists being filled stay valid.
+	std::vector<forest*> stack;
+
+public:
+	constexpr static bool needs_extra_info = false;
+
+	forest wood;
+
+	presized_read_listener(const std::vector<size_t>& counts) :
+		counts(counts)
+	{
+		this->wood.reserve(this->counts.front());
+		this->stack.push_back(&this->wood);
+	}
+
+	void on_children_parse_started(location)
+	{
+		ASSERT(!this->stack.back()->empty())
+		ASSERT(this->next_list < this->counts.size())
+		auto& children = this->stack.back()->back().children;
+		children.reserve(this->counts[this->next_list]);
+		++this->next_list;
+		this->stack.push_back(&children);
+	}
+
+	void on_children_parse_finished(location)
+	{
+		ASSERT(this->stack.size() > 1)
+		this->stack.pop_back();
+	}
+
+	void on_string_parsed(std::string&& str, const extra_info&)
+	{
+		auto& list = *this->stack.back();
+		ASSERT(list.size() < list.capacity())
+		list.emplace_back(std::move(str));
+	}
+};
+} // namespace
+
+forest tml::read_presized(std::string_view str)
+{
+	counting_listener counter;
+	tml::parse(utki::make_span(str), counter);
+
+	presized_read_listener listener(counter.counts);
+	tml::parse(utki::make_span(str), listener);
+
+	return std::move(listener.wood);
+}
+
+forest tml::read_mapped(const std::string& path)
 {
-	auto p = out.begin();
+	read_listener listener;
+
+	tml::parse_mapped(path, listener);
 
-	for (const auto& c : str) {
-		ASSERT(p != out.end())
+	return std::move(listener.cur_forest);
+}
+
+namespace {
+// Finds position at or after the given one, where the document can be split into chunks for parallel parsing.
+// The position is a beginning of a line which starts with a string token. If the parser is at top level
+// at such position, then the rest of the document can be parsed independently.
+size_t find_split_position(utki::span<const char> data, size_t pos)
+{
+	for (; pos < data.size(); ++pos) {
+		if (pos == 0 || data[pos - 1] != '\n') {
+			continue;
+		}
 
-		switch (c) {
+		switch (data[pos]) {
+			case '\0':
 			case '\t':
-				*p = '\\';
-				p = std::next(p);
-				ASSERT(p != out.end())
-				*p = 't';
-				break;
 			case '\n':
-				*p = '\\';
-				p = std::next(p);
-				ASSERT(p != out.end())
-				*p = 'n';
-				break;
-			case '\\':
-				*p = '\\';
-				p = std::next(p);
-				ASSERT(p != out.end())
-				*p = '\\';
-				break;
-			case '"':
-				*p = '\\';
-				p = std::next(p);
-				ASSERT(p != out.end())
-				*p = '"';
+			case '\r':
+			case ' ':
+			case '{':
+			case '}':
+			case '/':
 				break;
 			default:
-				*p = c;
-				break;
+				return pos;
 		}
-		p = std::next(p);
 	}
+	return data.size();
 }
 
-void write_internal(const tml::forest& roots, fsif::file& fi, formatting fmt, unsigned indentation)
+struct chunk_parsing
 {
-	const std::array<uint8_t, 1> quote = {{'"'}};
-	const std::array<uint8_t, 1> lcurly = {{'{'}};
-	const std::array<uint8_t, 1> rcurly = {{'}'}};
-	const std::array<uint8_t, 1> space = {{' '}};
-	const std::array<uint8_t, 1> tab = {{'\t'}};
-	const std::array<uint8_t, 1> new_line = {{'\n'}};
-
-	// used to detect case of two adjacent unquoted strings without children, need to insert space between them
-	bool prev_was_unquoted_without_children = false;
-
-	bool prev_had_children = true;
-
-	for (auto& n : roots) {
-		// indent
-		if (fmt == formatting::normal) {
-			for (unsigned i = 0; i != indentation; ++i) {
-				fi.write(utki::make_span(tab));
-			}
-		}
-
-		// write node value
-
-		//		TRACE(<< "writing node: " << n.value.string.c_str() << std::endl)
+	utki::span<const char> data;
+	read_listener listener;
+	internal::error_flag_sink errors;
+	tml::basic_parser<read_listener> parser;
+	bool parsed = false;
 
-		unsigned num_escapes = 0;
-		size_t length = 0;
-		bool unqouted = can_string_be_unquoted(
-			n.value.string, //
-			length,
-			num_escapes
-		);
-
-		if (!unqouted) {
-			fi.write(utki::make_span(quote));
+	void parse()
+	{
+		// The chunk may be parsed speculatively from a wrong position, so instead of throwing, the parser
+		// reports the problems to the sink. The chunk object is in its final place at this point,
+		// so it is safe to give the parser a pointer to the sink.
+		this->parser.set_diagnostics_sink(&this->errors);
+		this->parser.parse_data_chunk(this->data, this->listener);
+		this->parsed = true;
+	}
 
-			if (num_escapes == 0) {
-				fi.write(utki::make_span(n.value.string.c_str(), length));
-			} else {
-				std::vector<uint8_t> buf(length + num_escapes);
+	// Parses the chunk on a separate thread, where exceptions cannot be let through.
+	// In case of exception, e.g. out of memory, the chunk is left not parsed,
+	// then it will be parsed sequentially during validation.
+	void parse_speculatively() noexcept
+	{
+#if TML_EXCEPTIONS
+		try {
+#endif
+			this->parse();
+#if TML_EXCEPTIONS
+		} catch (...) {
+			ASSERT(!this->parsed)
+		}
+#endif
+	}
+};
+} // namespace
 
-				make_escaped_string(
-					n.value.string, //
-					utki::make_span(buf)
-				);
+forest tml::read_parallel(utki::span<const char> data, unsigned thread_count)
+{
+	if (thread_count == 0) {
+		thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	}
 
-				fi.write(utki::make_span(buf));
-			}
+	// do not split the document into too small chunks, so that the threading overhead is small
+	constexpr size_t min_chunk_size = 0x10000;
 
-			fi.write(utki::make_span(quote));
-		} else {
-			bool is_quoted_empty_string = false;
+	size_t num_chunks = std::min(size_t(thread_count), std::max(data.size() / min_chunk_size, size_t(1)));
 
-			if (length == 0) {
-				if (n.children.size() == 0 || !prev_had_children) {
-					is_quoted_empty_string = true;
-				}
+	std::vector<chunk_parsing> chunks;
+	chunks.reserve(num_chunks);
+	{
+		size_t chunk_begin = 0;
+		for (size_t i = 1; i < num_chunks; ++i) {
+			size_t chunk_end = find_split_position(data, std::max(chunk_begin + 1, data.size() * i / num_chunks));
+			if (chunk_end == data.size()) {
+				break;
 			}
+			chunks.emplace_back().data = data.subspan(chunk_begin, chunk_end - chunk_begin);
+			chunk_begin = chunk_end;
+		}
+		chunks.emplace_back().data = data.subspan(chunk_begin);
+	}
 
-			// if the string is unquoted then write space in case the output is unformatted
-			if (fmt != formatting::normal && prev_was_unquoted_without_children && !is_quoted_empty_string) {
-				fi.write(utki::make_span(space));
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(chunks.size() - 1);
+
+#if TML_EXCEPTIONS
+		try {
+#endif
+			for (auto i = std::next(chunks.begin()); i != chunks.end(); ++i) {
+				threads.emplace_back([&c = *i]() {
+					c.parse_speculatively();
+				});
 			}
+#if TML_EXCEPTIONS
+		} catch (...) {
+			// failed to start a thread, the chunks which are not parsed speculatively
+			// will be parsed during validation
+		}
+#endif
 
-			if (length == 0) {
-				if (is_quoted_empty_string) {
-					fi.write(utki::make_span(quote));
-					fi.write(utki::make_span(quote));
-				}
-			} else {
-				ASSERT(num_escapes == 0)
-				fi.write(utki::make_span(n.value.string.c_str(), length));
-				ASSERT(n.value.length() != 0)
-				if (n.children.size() == 0 && length == 1 && n.value[0] == 'R') {
-					fi.write(utki::make_span(space));
-				}
+		auto join_threads = [&threads]() {
+			for (auto& t : threads) {
+				t.join();
 			}
+		};
+
+		// the first chunk is parsed on the calling thread, so its exceptions are let through,
+		// but only after the other threads, which refer to the chunks, are finished
+#if TML_EXCEPTIONS
+		try {
+#endif
+			chunks.front().parse();
+#if TML_EXCEPTIONS
+		} catch (...) {
+			join_threads();
+			throw;
 		}
+#endif
 
-		prev_had_children = (n.children.size() != 0);
+		join_threads();
+	}
 
-		if (n.children.size() == 0) {
-			if (fmt == formatting::normal) {
-				fi.write(utki::make_span(new_line));
-			}
-			prev_was_unquoted_without_children = (unqouted && length != 0);
-			continue;
+	forest ret;
+
+	auto append_result = [&ret](chunk_parsing& c) {
+		c.parser.end_of_data(c.listener);
+		std::move(c.listener.cur_forest.begin(), c.listener.cur_forest.end(), std::back_inserter(ret));
+	};
+
+	// validate speculative parsing results and stitch the resulting forests together
+	auto cur = chunks.begin();
+	for (auto next = std::next(cur); next != chunks.end() && !cur->errors.error; ++next) {
+		if (cur->parser.is_at_top_level() && next->parsed && !next->errors.error) {
+			append_result(*cur);
+			cur = next;
 		} else {
-			prev_was_unquoted_without_children = false;
+			// the speculation has failed, continue parsing the chunk with the previous chunk's parser
+			cur->parser.parse_data_chunk(next->data, cur->listener);
 		}
+	}
+	append_result(*cur);
 
-		if (fmt != formatting::normal) {
-			fi.write(utki::make_span(lcurly));
+	if (cur->errors.error) {
+		// the document is malformed, parse it once again sequentially to report the error
+		// exactly the same way as tml::read() does
+		return tml::read(std::string_view(data.data(), data.size()));
+	}
 
-			write_internal(n.children, fi, fmt, 0);
+	return ret;
+}
 
-			fi.write(utki::make_span(rcurly));
-		} else {
-			fi.write(utki::make_span(lcurly));
-
-			if (n.children.size() == 1 && n.children[0].children.size() == 0) {
-				// if only one child and that child has no children then write the only child on the same line
-				write_internal(n.children, fi, formatting::minimal, 0);
-			} else {
-				fi.write(utki::make_span(new_line));
-				write_internal(n.children, fi, fmt, indentation + 1);
-
-				// indent
-				for (unsigned i = 0; i != indentation; ++i) {
-					fi.write(utki::make_span(tab));
-				}
-			}
-			fi.write(utki::make_span(rcurly));
-			fi.write(utki::make_span(new_line));
+namespace {
+void write_internal(const tml::forest& roots, writer& w)
+{
+	for (const auto& n : roots) {
+		w.string(n.value.string);
+
+		if (n.children.size() != 0) {
+			w.begin_children();
+			write_internal(n.children, w);
+			w.end_children();
 		}
 	}
 }
 } // namespace
 
+void tml::write(
+	const tml::forest& wood, //
+	sink& s,
+	formatting fmt,
+	size_t buffer_size
+)
+{
+	writer w(s, fmt, buffer_size);
+
+	write_internal(wood, w);
+
+	w.finish();
+}
+
 void tml::write(
 	const tml::forest& wood, //
 	fsif::file& fi,
@@ -291,7 +410,20 @@ void tml::write(
 		fsif::mode::create
 	);
 
-	write_internal(wood, fi, fmt, 0);
+	file_sink s(fi);
+
+	tml::write(wood, s, fmt);
+}
+
+void tml::write(
+	const tml::forest& wood, //
+	std::ostream& o,
+	formatting fmt
+)
+{
+	ostream_sink s(o);
+
+	tml::write(wood, s, fmt);
 }
 
 leaf::leaf(bool value) :
@@ -389,8 +521,7 @@ bool leaf::to_bool() const
 
 std::string tml::to_string(const forest& f)
 {
-	fsif::vector_file fi;
-	tml::write(f, fi, tml::formatting::minimal);
-	auto v = fi.reset_data();
-	return utki::make_string(v);
+	string_sink s;
+	tml::write(f, s, tml::formatting::minimal);
+	return std::move(s.str);
 }
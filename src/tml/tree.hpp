@@ -26,12 +26,17 @@ SOFTWARE.
 
 #pragma once
 
+#include <optional>
 #include <string>
 
 #include <fsif/file.hpp>
+#include <utki/span.hpp>
 #include <utki/string.hpp>
 #include <utki/tree.hpp>
 
+#include "diagnostics.hpp"
+#include "sink.hpp"
+
 // TODO: doxygen
 namespace tml {
 
@@ -205,17 +210,127 @@ using forest = tree::container_type;
 forest read(const fsif::file& fi);
 forest read(std::string_view str);
 
+/**
+ * @brief Read tml document into exactly sized node lists.
+ * The document is parsed twice. The first pass counts nodes of each children list, and the second one builds the forest
+ * reserving the exact memory for each node list beforehand. So, unlike tml::read(), the nodes are never moved
+ * due to node list reallocation, which pays off for documents having wide node lists, e.g. 10^5 siblings.
+ * For documents with narrow node lists the additional pass makes reading slower.
+ * @param str - the tml document.
+ * @return Parsed tml forest.
+ */
+forest read_presized(std::string_view str);
+
+/**
+ * @brief Read possibly malformed tml document.
+ * The problems of the document are reported to the diagnostics sink instead of throwing an exception,
+ * the document is read as recovered by the parser, see tml::basic_parser::set_diagnostics_sink().
+ * @param str - the tml document.
+ * @param diagnostics - diagnostics sink to report the problems to.
+ * @return Parsed tml forest.
+ */
+forest read(std::string_view str, diagnostics_sink& diagnostics);
+
+/**
+ * @brief Result of tml::try_read().
+ */
+struct read_result {
+	/**
+	 * @brief Parsed tml forest.
+	 * Empty in case the document is malformed.
+	 */
+	forest wood;
+
+	/**
+	 * @brief The first problem of the document.
+	 * Nothing in case the document is well-formed.
+	 */
+	std::optional<diagnostic> error;
+
+	/**
+	 * @brief Check if the document was read successfully.
+	 * @return true in case the document is well-formed.
+	 */
+	explicit operator bool() const noexcept
+	{
+		return !this->error.has_value();
+	}
+};
+
+/**
+ * @brief Read tml document without throwing on malformed document.
+ * Unlike tml::read(), this function does not throw in case the document is malformed,
+ * so it is usable when the library is compiled without exceptions support.
+ * @param str - the tml document.
+ * @return Parsed tml forest or the first problem of the document.
+ */
+read_result try_read(std::string_view str);
+
+/**
+ * @brief Read tml document from file system file.
+ * The file is memory-mapped if possible, see tml::parse_mapped().
+ * @param path - path to the file.
+ * @return Parsed tml forest.
+ */
+forest read_mapped(const std::string& path);
+
+/**
+ * @brief Read tml document using several threads.
+ * The document is split into chunks at line beginnings. The chunks are parsed concurrently,
+ * each chunk, except the first one, is parsed speculatively assuming that it starts at top level of the document.
+ * After that the assumptions are validated one by one, the chunks for which the assumption turned out to be wrong
+ * are parsed once again as continuation of the previous chunk. So, the speed-up is achieved for documents
+ * consisting of many top-level nodes, while for any document the result is the same as of tml::read().
+ * @param data - the tml document.
+ * @param thread_count - maximum number of threads to use. 0 means use number of hardware threads.
+ * @return Parsed tml forest.
+ */
+forest read_parallel(utki::span<const char> data, unsigned thread_count = 0);
+
 enum class formatting {
 	normal,
 	minimal
 };
 
+/**
+ * @brief Write tml document.
+ * The output is buffered and written to the sink in blocks of the buffer size.
+ * @param wood - forest to write.
+ * @param s - sink to write the document to.
+ * @param fmt - formatting of the output.
+ * @param buffer_size - size of the output buffer.
+ */
+void write(
+	const forest& wood, //
+	sink& s,
+	formatting fmt = formatting::normal,
+	size_t buffer_size = buffered_sink::default_buffer_size
+);
+
+/**
+ * @brief Write tml document to file.
+ * @param wood - forest to write.
+ * @param fi - file interface to write the document to. The file is opened in create mode.
+ * @param fmt - formatting of the output.
+ */
 void write(
 	const forest& wood, //
 	fsif::file& fi,
 	formatting fmt = formatting::normal
 );
 
+/**
+ * @brief Write tml document to output stream.
+ * @param wood - forest to write.
+ * @param o - stream to write the document to.
+ * @param fmt - formatting of the output.
+ */
+void write(
+	const forest& wood, //
+	std::ostream& o,
+	formatting fmt = formatting::normal
+);
+
 std::string to_string(const forest& f);
 
 inline std::string to_string(const tree& t)
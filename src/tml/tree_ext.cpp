@@ -26,58 +26,418 @@ SOFTWARE.
 
 #include "tree_ext.hpp"
 
-#include <stack>
-
-#include <fsif/span_file.hpp>
+#include <algorithm>
 
+#include "forest_builder.hpp"
 #include "parser.hpp"
 
 using namespace tml;
 
-forest_ext tml::read_ext(const fsif::file& fi)
+namespace {
+class read_ext_listener : public internal::forest_builder<forest_ext>
 {
-	class the_listener : public tml::listener
+public:
+	void on_string_parsed(std::string&& str, const extra_info& info)
 	{
-		std::stack<forest_ext> stack;
+		this->cur_forest.emplace_back(leaf_ext(std::move(str), info));
+	}
+};
 
-	public:
-		forest_ext cur_forest;
+// Builds the plain forest and stores the extra info of the nodes to a separate array.
+template <typename info_container_type>
+class read_info_listener : public internal::forest_builder<forest>
+{
+public:
+	info_container_type& info;
 
-		void on_children_parse_started(location /* loc */) override
-		{
-			this->stack.push(std::move(this->cur_forest));
-			utki::assert(this->cur_forest.size() == 0, SL);
+	read_info_listener(info_container_type& info) :
+		info(info)
+	{}
+
+	void on_string_parsed(std::string&& str, const extra_info& info)
+	{
+		this->cur_forest.emplace_back(std::move(str));
+		this->info.push_back(info);
+	}
+};
+} // namespace
+
+class tml::internal::region_parsing
+{
+public:
+	// Set the formatting flags the parser has at the beginning of the region
+	// in case it parses the document from its beginning.
+	// The flags are the same as the ones of the first node of the region.
+	template <typename listener_type>
+	static void set_preceding_flags(basic_parser<listener_type>& parser, utki::flags<flag> first_node_flags)
+	{
+		parser.info.flags.clear();
+		for (auto f : {flag::space, flag::first_on_line}) {
+			parser.info.flags.set(f, first_node_flags.get(f));
 		}
+	}
+};
 
-		void on_children_parse_finished(location loc) override
-		{
-			if (this->stack.size() == 0) {
-				std::stringstream ss;
-				ss << "malformed tml: unopened curly brace encountered at ";
-				ss << loc.line << ":" << loc.offset;
-				throw std::invalid_argument(ss.str());
+forest_ext tml::read_ext(const fsif::file& fi)
+{
+	read_ext_listener listener;
+
+	tml::parse(fi, listener);
+
+	return std::move(listener.cur_forest);
+}
+
+forest_ext tml::read_ext(const std::string& str)
+{
+	read_ext_listener listener;
+
+	tml::parse(utki::make_span(str), listener);
+
+	return std::move(listener.cur_forest);
+}
+
+namespace {
+template <typename info_container_type>
+forest read_with_info(std::string_view str, info_container_type& info)
+{
+	info.clear();
+
+	read_info_listener<info_container_type> listener(info);
+
+	tml::parse(utki::make_span(str), listener);
+
+	return std::move(listener.cur_forest);
+}
+} // namespace
+
+forest tml::read_ext(std::string_view str, std::vector<extra_info>& info)
+{
+	return read_with_info(str, info);
+}
+
+forest tml::read_ext(std::string_view str, extra_info_table& info)
+{
+	return read_with_info(str, info);
+}
+
+namespace {
+size_t start_of(const tree_ext& t)
+{
+	return t.value.info.location.byte_offset;
+}
+
+// The empty string reported before "/{" gets extra info of the preceding node, or no location at all
+// in case it is the first node of the document, so its location does not tell where its token is.
+bool has_own_location(const tree_ext& t)
+{
+	const auto& v = t.value;
+	if (v.info.location.line == 0) {
+		return false;
+	}
+	return !v.string.empty() || v.info.flags.get(flag::quoted) || v.info.flags.get(flag::raw);
+}
+
+// Check if parsing the document from the beginning of the given node is equivalent to parsing it from
+// the document beginning. It is so in case the node is preceded by a character which terminates any preceding token.
+bool can_start_parsing_at(const tree_ext& t, std::string_view text)
+{
+	if (!has_own_location(t)) {
+		return false;
+	}
+
+	auto pos = start_of(t);
+
+	// The slash can start a comment, after which the parser returns to the state it had before the node,
+	// or it can be followed by '{', before which an empty string is reported with extra info of the preceding node.
+	if (text[pos] == '/') {
+		return false;
+	}
+
+	if (pos == 0) {
+		return true;
+	}
+
+	switch (text[pos - 1]) {
+		case '\n':
+		case '\r':
+		case '\t':
+		case ' ':
+		case '{':
+		case '}':
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Check if parsing the token of the given node, which is at the given position in the edited text,
+// separately from the text following it gives the same node and does not affect parsing of the following nodes.
+bool can_stop_parsing_at(const forest_ext& list, size_t index, std::string_view text, size_t pos)
+{
+	const auto& t = list[index];
+	if (!has_own_location(t) || pos >= text.size()) {
+		return false;
+	}
+
+	// the empty string reported before "/{" copies extra info of the node, which can be changed by parsing
+	if (index + 1 != list.size() && !has_own_location(list[index + 1])) {
+		return false;
+	}
+
+	// the slash can be followed by '{', before which an empty string is reported
+	if (text[pos] == '/') {
+		return false;
+	}
+
+	// the 'R' followed by double quote passes its formatting flags to the string after it
+	if (t.value.string == "R" && t.value.info.length == 1 && text.substr(pos, 2) == "R\"") {
+		return false;
+	}
+
+	return true;
+}
+
+// Range of sibling nodes to be parsed again.
+struct region {
+	forest_ext* list;
+
+	// indices of the first node to parse again and of the first node after those,
+	// in case there is no node after those, the region extends to the end of the document
+	size_t begin;
+	size_t end;
+
+	// in case the region starts from the document beginning the nodes before the first node of the region,
+	// e.g. comments, are parsed again as well
+	bool from_document_begin;
+
+	// ancestors of the region nodes, as list and index of the ancestor in the list
+	std::vector<std::pair<forest_ext*, size_t>> path;
+};
+
+// Find regions enclosing the edit, from the outermost to the innermost one.
+// At top level the region can always extend to the document beginning and end, so there is at least one region.
+std::vector<region> find_regions(
+	forest_ext& wood, //
+	std::string_view text,
+	size_t edit_begin,
+	size_t edit_end
+)
+{
+	std::vector<region> ret;
+
+	std::vector<std::pair<forest_ext*, size_t>> path;
+
+	for (forest_ext* list = &wood;;) {
+		auto after_edit = std::partition_point(list->begin(), list->end(), [&](const auto& n) {
+			return start_of(n) < edit_end;
+		});
+		auto not_before_edit = std::partition_point(list->begin(), after_edit, [&](const auto& n) {
+			return start_of(n) < edit_begin;
+		});
+
+		auto begin = std::find_if(
+			std::make_reverse_iterator(not_before_edit), //
+			list->rend(),
+			[&](const auto& n) {
+				return can_start_parsing_at(n, text);
 			}
-			this->stack.top().back().children = std::move(this->cur_forest);
-			this->cur_forest = std::move(this->stack.top());
-			this->stack.pop();
+		);
+
+		if (begin != list->rend() && (after_edit != list->end() || path.empty())) {
+			// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+			ret.push_back({
+				list,
+				size_t(std::distance(list->begin(), begin.base()) - 1),
+				size_t(std::distance(list->begin(), after_edit)),
+				false,
+				path
+			});
+		} else if (path.empty()) {
+			// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+			ret.push_back({list, 0, size_t(std::distance(list->begin(), after_edit)), true, {}});
+		}
+
+		// descend into the node containing the edit, if any, to find a smaller region
+		if (not_before_edit == list->begin()) {
+			break;
+		}
+		auto containing = std::prev(not_before_edit);
+		if (containing->children.empty()) {
+			break;
+		}
+		path.emplace_back(list, std::distance(list->begin(), containing));
+		list = &containing->children;
+	}
+
+	return ret;
+}
+
+// Convert locations of the nodes parsed starting from the given base location to locations in the whole document.
+void rebase_locations(forest_ext& f, const location& base)
+{
+	for (auto& n : f) {
+		auto& loc = n.value.info.location;
+		if (loc.line == 1) {
+			loc.offset += base.offset - 1;
+		}
+		loc.line += base.line - 1;
+		loc.byte_offset += base.byte_offset;
+
+		rebase_locations(n.children, base);
+	}
+}
+
+struct location_shift {
+	size_t line; // the line on which the offsets are shifted, original line number
+	ptrdiff_t lines;
+	ptrdiff_t offsets;
+	ptrdiff_t bytes;
+
+	void apply(location& loc) const noexcept
+	{
+		if (loc.line == this->line) {
+			loc.offset = size_t(ptrdiff_t(loc.offset) + this->offsets);
+		}
+		loc.line = size_t(ptrdiff_t(loc.line) + this->lines);
+		loc.byte_offset = size_t(ptrdiff_t(loc.byte_offset) + this->bytes);
+	}
+};
+
+void shift_locations(forest_ext::iterator begin, forest_ext::iterator end, const location_shift& shift)
+{
+	for (auto i = begin; i != end; ++i) {
+		shift.apply(i->value.info.location);
+		shift_locations(i->children.begin(), i->children.end(), shift);
+	}
+}
+
+// Returns false in case the edit affects the document outside of the region,
+// so that the region cannot be parsed separately.
+bool reparse_region(
+	const region& r, //
+	std::string_view text,
+	ptrdiff_t delta
+)
+{
+	auto& list = *r.list;
+
+	bool has_next = r.end != list.size();
+
+	// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+	location base = {1, 1, 0};
+	if (!r.from_document_begin) {
+		base = list[r.begin].value.info.location;
+	}
+
+	size_t text_begin = base.byte_offset;
+	size_t text_end = has_next ? size_t(ptrdiff_t(start_of(list[r.end])) + delta) : text.size();
+	if (text_end < text_begin || text_end > text.size()) {
+		return false;
+	}
+	if (has_next && !can_stop_parsing_at(list, r.end, text, text_end)) {
+		return false;
+	}
+
+	read_ext_listener listener;
+	internal::error_flag_sink errors;
+	basic_parser<read_ext_listener> parser;
+	parser.set_diagnostics_sink(&errors);
+
+	if (!r.from_document_begin) {
+		// the formatting flags depend on the text preceding the region, which is not changed
+		internal::region_parsing::set_preceding_flags(parser, list[r.begin].value.info.flags);
+	}
+
+	parser.parse_data_chunk(utki::make_span(text.substr(text_begin, text_end - text_begin)), listener);
+
+	if (has_next) {
+		// parse the token of the node following the region to check that it is not affected by the edit
+		// and to update its flags which depend on the preceding text
+		if (!parser.is_at_top_level()) {
+			return false;
+		}
+		parser.parse_data_chunk(
+			utki::make_span(text.substr(text_end, list[r.end].value.info.length)), //
+			listener
+		);
+	}
+
+	parser.end_of_data(listener);
+
+	if (errors.error) {
+		return false;
+	}
+
+	auto& parsed = listener.cur_forest;
+
+	rebase_locations(parsed, base);
+
+	if (has_next) {
+		if (parsed.empty()) {
+			return false;
 		}
 
-		void on_string_parsed(std::string_view str, const extra_info& info) override
+		const auto& next = list[r.end].value;
+		const auto& parsed_next = parsed.back().value;
+		if (parsed_next != next || parsed_next.info.location.byte_offset != text_end ||
+			parsed_next.info.length != next.info.length)
 		{
-			this->cur_forest.emplace_back(leaf_ext(std::string(str.data(), str.size()), info));
+			return false;
 		}
-	} listener;
 
-	tml::parse(fi, listener);
+		// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+		location_shift shift = {
+			next.info.location.line,
+			ptrdiff_t(parsed_next.info.location.line) - ptrdiff_t(next.info.location.line),
+			ptrdiff_t(parsed_next.info.location.offset) - ptrdiff_t(next.info.location.offset),
+			delta
+		};
 
-	return std::move(listener.cur_forest);
+		auto first_shifted = std::next(list.begin(), ptrdiff_t(r.end));
+		shift_locations(first_shifted, list.end(), shift);
+		for (const auto& a : r.path) {
+			shift_locations(std::next(a.first->begin(), ptrdiff_t(a.second + 1)), a.first->end(), shift);
+		}
+
+		for (auto f : {flag::space, flag::first_on_line}) {
+			first_shifted->value.info.flags.set(f, parsed_next.info.flags.get(f));
+		}
+
+		parsed.pop_back();
+	}
+
+	auto pos = list.erase(std::next(list.begin(), ptrdiff_t(r.begin)), std::next(list.begin(), ptrdiff_t(r.end)));
+	list.insert(pos, std::make_move_iterator(parsed.begin()), std::make_move_iterator(parsed.end()));
+
+	return true;
 }
+} // namespace
 
-forest_ext tml::read_ext(const std::string& str)
+void tml::reparse_ext(
+	forest_ext& wood, //
+	std::string_view text,
+	const text_edit& edit
+)
 {
-	const fsif::span_file fi(to_uint8_t(utki::make_span(str)));
+	if (edit.offset + edit.replacement.size() > text.size()) {
+		internal::throw_exception(std::invalid_argument("tml::reparse_ext(): the edit is out of the text bounds"));
+	}
+
+	auto regions = find_regions(wood, text, edit.offset, edit.offset + edit.length);
 
-	return read_ext(fi);
+	// try the smallest region first, in case the edit affects the text outside of it, try the enclosing ones
+	for (auto r = regions.rbegin(); r != regions.rend(); ++r) {
+		if (reparse_region(*r, text, ptrdiff_t(edit.replacement.size()) - ptrdiff_t(edit.length))) {
+			return;
+		}
+	}
+
+	// the edit has changed the document structure, parse the whole document
+	read_ext_listener listener;
+
+	tml::parse(utki::make_span(text), listener);
+
+	wood = std::move(listener.cur_forest);
 }
 
 tree tml::to_non_ext(const tree_ext& t)
@@ -93,6 +453,7 @@ tree tml::to_non_ext(const tree_ext& t)
 forest tml::to_non_ext(const forest_ext& f)
 {
 	forest ret;
+	ret.reserve(f.size());
 
 	for (const auto& c : f) {
 		ret.push_back(to_non_ext(c));
@@ -100,3 +461,28 @@ forest tml::to_non_ext(const forest_ext& f)
 
 	return ret;
 }
+
+tree tml::to_non_ext(tree_ext&& t)
+{
+	tree ret;
+
+	ret.value = std::move(static_cast<leaf&>(t.value));
+	ret.children = to_non_ext(std::move(t.children));
+
+	return ret;
+}
+
+forest tml::to_non_ext(forest_ext&& f)
+{
+	// take over the source forest, so that its memory is freed when it is converted
+	forest_ext src = std::move(f);
+
+	forest ret;
+	ret.reserve(src.size());
+
+	for (auto& c : src) {
+		ret.push_back(to_non_ext(std::move(c)));
+	}
+
+	return ret;
+}
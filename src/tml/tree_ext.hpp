@@ -26,7 +26,10 @@ SOFTWARE.
 
 #pragma once
 
+#include <vector>
+
 #include "extra_info.hpp"
+#include "extra_info_table.hpp"
 #include "tree.hpp"
 
 namespace tml {
@@ -67,7 +70,82 @@ using forest_ext = tree_ext::container_type;
 forest_ext read_ext(const fsif::file& fi);
 forest_ext read_ext(const std::string& str);
 
+/**
+ * @brief Read tml document into plain forest and extra info side table.
+ * Instead of storing the extra info in the nodes, as tml::read_ext() does, the extra info of the nodes is stored
+ * in a separate array. The nodes are numbered in pre-order, i.e. in the order they appear in the document,
+ * and the array is indexed by the node number.
+ * @param str - the tml document.
+ * @param info - array to store the extra info of the nodes to. Its previous contents are discarded.
+ * @return Parsed tml forest.
+ */
+forest read_ext(std::string_view str, std::vector<extra_info>& info);
+
+/**
+ * @brief Read tml document into plain forest and compact extra info side table.
+ * Same as read_ext(std::string_view, std::vector<extra_info>&), but the extra info is stored in the compact form.
+ * @param str - the tml document.
+ * @param info - table to store the extra info of the nodes to. Its previous contents are discarded.
+ * @return Parsed tml forest.
+ */
+forest read_ext(std::string_view str, extra_info_table& info);
+
+/**
+ * @brief Description of a text edit.
+ * The edit replaces a range of the original document text with a new text.
+ */
+struct text_edit {
+	/**
+	 * @brief Byte offset of the replaced range in the original text.
+	 */
+	size_t offset = 0;
+
+	/**
+	 * @brief Length of the replaced range in bytes.
+	 */
+	size_t length = 0;
+
+	/**
+	 * @brief The text which replaces the range.
+	 */
+	std::string_view replacement;
+};
+
+/**
+ * @brief Update forest to reflect an edit of the document.
+ * Instead of parsing the whole edited document, only the smallest range of sibling nodes enclosing the edit
+ * is parsed again, the resulting nodes replace the old ones and the locations of the nodes following the edit
+ * are shifted. In case the edit changes the structure of the document outside of that range, e.g. the edit
+ * opens a quoted string or a comment, the whole document is parsed again.
+ * The result is the same as of tml::read_ext() of the edited text.
+ * @param wood - forest read with tml::read_ext() from the original text. It is updated in place.
+ * @param text - the edited text, i.e. the original text with the edit applied.
+ * @param edit - the edit, in terms of the original text.
+ */
+void reparse_ext(
+	forest_ext& wood, //
+	std::string_view text,
+	const text_edit& edit
+);
+
 tree to_non_ext(const tree_ext& t);
 forest to_non_ext(const forest_ext& f);
 
+/**
+ * @brief Convert tree_ext to tree consuming the source tree.
+ * The strings are moved from the source tree instead of being copied.
+ * @param t - tree to convert.
+ * @return Converted tree.
+ */
+tree to_non_ext(tree_ext&& t);
+
+/**
+ * @brief Convert forest_ext to forest consuming the source forest.
+ * The strings are moved from the source forest instead of being copied,
+ * and the memory of the source node lists is freed as soon as they are converted.
+ * @param f - forest to convert.
+ * @return Converted forest.
+ */
+forest to_non_ext(forest_ext&& f);
+
 } // namespace tml
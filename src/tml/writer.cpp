@@ -0,0 +1,268 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#include "writer.hpp"
+
+#include "parser.hpp"
+
+using namespace tml;
+
+namespace {
+// Writes the string with the characters which are special in quoted string escaped.
+// The characters before the given position are known to need no escaping.
+void write_escaped_string(std::string_view str, size_t pos, buffered_sink& out)
+{
+	out.write(utki::make_span(str.substr(0, pos)));
+
+	while (pos != str.size()) {
+		auto run_length = internal::find_any_of<'\t', '\n', '\\', '"'>(utki::make_span(str.substr(pos)));
+		out.write(utki::make_span(str.substr(pos, run_length)));
+		pos += run_length;
+
+		if (pos == str.size()) {
+			break;
+		}
+
+		out.write('\\');
+		switch (str[pos]) {
+			case '\t':
+				out.write('t');
+				break;
+			case '\n':
+				out.write('n');
+				break;
+			default:
+				out.write(str[pos]);
+				break;
+		}
+		++pos;
+	}
+}
+} // namespace
+
+writer::writer(
+	sink& s, //
+	formatting fmt,
+	size_t buffer_size
+) :
+	out(s, buffer_size)
+{
+	this->stack.push_back({fmt != formatting::normal, 0});
+}
+
+void writer::write_node(std::string_view str)
+{
+	auto& f = this->stack.back();
+
+	if (!f.minimal) {
+		this->out.write('\t', f.indentation);
+	}
+
+	// position of the first character which cannot be in unquoted string
+	size_t special_pos = internal::find_any_of<'\t', '\n', '\\', '"', '{', '}', ' '>(utki::make_span(str));
+
+	// empty string cannot be unquoted
+	this->last_was_unquoted = !str.empty() && special_pos == str.size();
+	this->last_was_r = false;
+
+	if (!this->last_was_unquoted) {
+		this->out.write('"');
+		write_escaped_string(str, special_pos, this->out);
+		this->out.write('"');
+		return;
+	}
+
+	// if the string is unquoted then write space in case the output is unformatted
+	if (f.minimal && f.prev_was_unquoted_without_children) {
+		this->out.write(' ');
+	}
+
+	this->out.write(utki::make_span(str));
+
+	this->last_was_r = str == "R";
+}
+
+void writer::finish_node_without_children()
+{
+	auto& f = this->stack.back();
+
+	// unquoted R followed by quoted string would be a raw string opening sequence
+	if (this->last_was_r) {
+		this->out.write(' ');
+	}
+
+	if (!f.minimal) {
+		this->out.write('\n');
+	}
+
+	f.prev_was_unquoted_without_children = this->last_was_unquoted;
+	this->cur_state = state::idle;
+}
+
+void writer::finish_node_with_children()
+{
+	this->stack.back().prev_was_unquoted_without_children = false;
+	this->out.write('{');
+}
+
+void writer::write_first_child_on_separate_line()
+{
+	ASSERT(this->cur_state == state::first_child || this->cur_state == state::first_child_children_opened)
+
+	this->out.write('\n');
+
+	const auto& parent = this->stack.back();
+	this->stack.push_back({false, parent.indentation + 1});
+
+	this->write_node(this->first_child);
+	this->first_child.clear();
+}
+
+void writer::close_children()
+{
+	ASSERT(this->cur_state == state::idle)
+
+	if (this->stack.size() == 1) {
+		internal::throw_exception(std::logic_error("tml::writer::end_children(): no children list to end"));
+	}
+
+	this->stack.pop_back();
+
+	const auto& f = this->stack.back();
+	if (!f.minimal) {
+		this->out.write('\t', f.indentation);
+	}
+
+	this->out.write('}');
+
+	if (!f.minimal) {
+		this->out.write('\n');
+	}
+}
+
+void writer::string(std::string_view str)
+{
+	switch (this->cur_state) {
+		case state::node_written:
+			this->finish_node_without_children();
+			[[fallthrough]];
+		case state::idle:
+			this->write_node(str);
+			this->cur_state = state::node_written;
+			break;
+		case state::children_opened:
+			this->finish_node_with_children();
+			if (this->stack.back().minimal) {
+				this->stack.push_back({true, 0});
+				this->write_node(str);
+				this->cur_state = state::node_written;
+			} else {
+				this->first_child = str;
+				this->cur_state = state::first_child;
+			}
+			break;
+		case state::first_child:
+			// more than one child, the children are written on separate lines
+			this->write_first_child_on_separate_line();
+			this->finish_node_without_children();
+			this->write_node(str);
+			this->cur_state = state::node_written;
+			break;
+		case state::first_child_children_opened:
+			// the first child has children, the children are written on separate lines
+			this->write_first_child_on_separate_line();
+			this->finish_node_with_children();
+			this->first_child = str;
+			this->cur_state = state::first_child;
+			break;
+	}
+}
+
+void writer::begin_children()
+{
+	switch (this->cur_state) {
+		case state::node_written:
+			this->cur_state = state::children_opened;
+			break;
+		case state::first_child:
+			this->cur_state = state::first_child_children_opened;
+			break;
+		case state::idle:
+		case state::children_opened:
+		case state::first_child_children_opened:
+			internal::throw_exception(std::logic_error("tml::writer::begin_children(): no node to begin children list of"));
+	}
+}
+
+void writer::end_children()
+{
+	switch (this->cur_state) {
+		case state::node_written:
+			this->finish_node_without_children();
+			[[fallthrough]];
+		case state::idle:
+			this->close_children();
+			break;
+		case state::children_opened:
+			// empty children list, same as no children
+			this->cur_state = state::node_written;
+			break;
+		case state::first_child:
+			// the only child without children is written on the same line as its parent
+			this->stack.push_back({true, 0});
+			this->write_node(this->first_child);
+			this->first_child.clear();
+			this->finish_node_without_children();
+			this->stack.pop_back();
+			this->out.write('}');
+			this->out.write('\n');
+			break;
+		case state::first_child_children_opened:
+			// empty children list of the first child, same as no children
+			this->cur_state = state::first_child;
+			break;
+	}
+}
+
+void writer::finish()
+{
+	switch (this->cur_state) {
+		case state::node_written:
+			this->finish_node_without_children();
+			break;
+		case state::idle:
+			break;
+		default:
+			internal::throw_exception(std::logic_error("tml::writer::finish(): children list is not ended"));
+	}
+
+	if (this->stack.size() != 1) {
+		internal::throw_exception(std::logic_error("tml::writer::finish(): children list is not ended"));
+	}
+
+	this->out.flush();
+}
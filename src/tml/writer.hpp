@@ -0,0 +1,149 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2025 Ivan Gagis <igagis@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "extra_info.hpp"
+#include "sink.hpp"
+#include "tree.hpp"
+
+namespace tml {
+
+/**
+ * @brief Streaming tml writer.
+ * Writes tml document node by node, so that the whole document does not need to be
+ * present in memory. The output is the same as of tml::write() for the forest consisting of the same nodes.
+ * To achieve that, the writer defers writing of some output until it knows
+ * whether a node has children and whether the children list consists of a single leaf node, but
+ * it never holds more than one node's string at a time.
+ *
+ * The writer also has methods of the parser listener, so it can be used as a listener for tml::parse()
+ * to reformat a document without building a forest.
+ */
+class writer
+{
+	buffered_sink out;
+
+	struct frame {
+		bool minimal;
+		unsigned indentation;
+
+		// used to detect case of two adjacent unquoted strings without children, need to insert space between them
+		bool prev_was_unquoted_without_children = false;
+	};
+
+	// children lists being written, the first one is the list of top-level nodes
+	std::vector<frame> stack;
+
+	enum class state {
+		// nothing is deferred
+		idle,
+
+		// the last node is written, but it is not known yet whether it has children
+		node_written,
+
+		// the children list of the last node is opened, but it is not known yet whether it is empty
+		children_opened,
+
+		// the first child of the last node is received, but it is not known yet whether it is
+		// the only child without children, in which case it is written on the same line as its parent
+		first_child,
+
+		// the children list of the first child is opened, but it is not known yet whether it is empty
+		first_child_children_opened
+	} cur_state = state::idle;
+
+	bool last_was_unquoted = false;
+	bool last_was_r = false;
+
+	std::string first_child;
+
+	void write_node(std::string_view str);
+	void finish_node_without_children();
+	void finish_node_with_children();
+	void write_first_child_on_separate_line();
+	void close_children();
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @param s - sink to write the document to.
+	 * @param fmt - formatting of the output.
+	 * @param buffer_size - size of the output buffer.
+	 */
+	writer(
+		sink& s, //
+		formatting fmt = formatting::normal,
+		size_t buffer_size = buffered_sink::default_buffer_size
+	);
+
+	/**
+	 * @brief Write node.
+	 * @param str - node's string.
+	 */
+	void string(std::string_view str);
+
+	/**
+	 * @brief Begin children list of the last written node.
+	 */
+	void begin_children();
+
+	/**
+	 * @brief End the current children list.
+	 */
+	void end_children();
+
+	/**
+	 * @brief Finish writing.
+	 * Writes all the deferred output and flushes the output buffer to the sink.
+	 * All children lists must be closed.
+	 */
+	void finish();
+
+	constexpr static bool needs_extra_info = false;
+
+	void on_string_parsed(std::string_view str, const extra_info&)
+	{
+		this->string(str);
+	}
+
+	void on_children_parse_started(location)
+	{
+		this->begin_children();
+	}
+
+	void on_children_parse_finished(location)
+	{
+		this->end_children();
+	}
+};
+
+} // namespace tml
@@ -0,0 +1,56 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <cstdlib>
+#include <new>
+
+#include "../../../src/tml/parser.hpp"
+
+// The global allocation functions are replaced for this test program only, so that the other tests run
+// with the standard allocator. The default array and nothrow forms of operator new call the replaced
+// operator new, and the default forms of operator delete call the replaced one, so all the allocations are counted.
+
+namespace{
+// the tests are run in parallel, so count the heap allocations of the current thread only
+thread_local size_t num_allocations = 0;
+}
+
+void* operator new(size_t size){
+	++num_allocations;
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+	if(void* p = std::malloc(size == 0 ? 1 : size)){
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p)noexcept{
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+	std::free(p);
+}
+
+namespace{
+const tst::set set("validate", [](tst::suite& suite){
+	suite.add<std::string_view>(
+		"validation_does_not_allocate_memory",
+		{
+			"a{b{c d} e} f{}",
+			"\"abcdefghijklmnopqrstuvwxyz \\u0bf5 {0123456789} abcdefghijklmnopqrstuvwxyz\"",
+			"abcdefghijklmnopqrstuvwxyz\\ 0123456789_abcdefghijklmnopqrstuvwxyz{child}",
+			"R\"0123456789abcdef(abcdefghijklmnopqrstuvwxyz)0123456789abcdef\"",
+			"R\"0123456789abcdefghijklmnopqrstuvwxyz\"",
+			"R\"0123456789abcdefghijklmnopqrstuvwxyz(abcdefghijklmnopqrstuvwxyz)0123456789abcdefghijklmnopqrstuvwxyz\"",
+			"R\"0123456789abcdefghijklmnopqrstuvwxyz(unterminated",
+			"\"\"\"abcdefghijklmnopqrstuvwxyz \"\" 0123456789\"\"\"",
+			"a /* ** abcdefghijklmnopqrstuvwxyz ********************************** **/ b",
+			"R\"0123456789abcdef(unterminated",
+			R"(a "\u12zz")",
+		},
+		[](const auto& p){
+			auto num_allocations_before = num_allocations;
+			tml::validate(utki::make_span(p));
+			tst::check_eq(num_allocations, num_allocations_before, SL);
+		}
+	);
+});
+}
@@ -95,5 +95,41 @@ const tst::set set("crawler", [](auto& suite){
 		}
 		tst::check(thrown, SL);
 	});
+
+	suite.add("non_throwing_crawling", [](){
+		tml::crawler c(roots);
+
+		tst::check(!c.try_to("b-1"), SL);
+		tst::check_eq(c.get().value, tml::leaf("b1"), SL);
+
+		tst::check(c.try_to("b5"), SL);
+		tst::check(c.try_next(), SL);
+		tst::check_eq(c.get().value, tml::leaf("b6"), SL);
+
+		auto b6 = c.try_in();
+		tst::check(b6.has_value(), SL);
+		tst::check(!b6->try_to_if(predicate_str("b6-1")), SL);
+		tst::check(b6->try_to_if(predicate_str("b6_1")), SL);
+		tst::check(!b6->try_next(), SL);
+		tst::check_eq(b6->get().value, tml::leaf("b6_1"), SL);
+
+		auto b6_1 = b6->try_in();
+		tst::check(b6_1.has_value(), SL);
+		tst::check(b6_1->try_to("b6_1_2"), SL);
+		tst::check(!b6_1->try_in().has_value(), SL);
+	});
+
+	suite.add("non_throwing_const_crawling", [](){
+		tml::const_crawler c(const_roots);
+
+		tst::check(c.try_to("b8"), SL);
+		tst::check(!c.try_next(), SL);
+
+		auto b8 = c.try_in();
+		tst::check(b8.has_value(), SL);
+		tst::check(b8->try_to("b8_2"), SL);
+		tst::check(!b8->try_to("b8_1"), SL);
+		tst::check_eq(b8->get().value, tml::leaf("b8_2"), SL);
+	});
 });
 }
@@ -0,0 +1,112 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include "../../../src/tml/tree.hpp"
+
+namespace{
+class diagnostics_collector : public tml::diagnostics_sink{
+public:
+	std::vector<tml::diagnostic> diagnostics;
+
+	void report(const tml::diagnostic& d)override{
+		this->diagnostics.push_back(d);
+	}
+};
+
+struct expected_diagnostic{
+	tml::diagnostic_kind kind;
+	size_t line;
+	size_t offset;
+	size_t byte_offset;
+};
+
+struct sample{
+	std::string_view document;
+	std::string_view recovered;
+	std::vector<expected_diagnostic> diagnostics;
+};
+}
+
+namespace{
+const tst::set set("diagnostics", [](tst::suite& suite){
+	suite.add<sample>(
+		"malformed_document_is_recovered_and_all_problems_are_reported",
+		{
+			// NOLINTBEGIN(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+			{"a b c", "a b c", {}},
+			{"a {b} {c}", R"(a{b}""{c})", {
+				{tml::diagnostic_kind::unexpected_opening_curly_brace, 1, 7, 6}
+			}},
+			{"a}\nb}}", "a b", {
+				{tml::diagnostic_kind::unexpected_closing_curly_brace, 1, 2, 1},
+				{tml::diagnostic_kind::unexpected_closing_curly_brace, 2, 2, 4},
+				{tml::diagnostic_kind::unexpected_closing_curly_brace, 2, 3, 5}
+			}},
+			{"a{b{c", "a{b{c}}", {
+				{tml::diagnostic_kind::unclosed_children_list, 1, 6, 5},
+				{tml::diagnostic_kind::unclosed_children_list, 1, 6, 5}
+			}},
+			{R"(a "b\uzzzzc" d)", R"(a bc d)", {
+				{tml::diagnostic_kind::invalid_unicode_escape_sequence, 1, 10, 9}
+			}},
+			{R"(a \uzzzz b)", R"(a b)", {
+				{tml::diagnostic_kind::invalid_unicode_escape_sequence, 1, 8, 7}
+			}},
+			{R"(\uzzzz)", "", {
+				{tml::diagnostic_kind::invalid_unicode_escape_sequence, 1, 6, 5}
+			}},
+			{R"(a\uzzzzb \U0001f60z{c})", R"(ab ""{c})", {
+				{tml::diagnostic_kind::invalid_unicode_escape_sequence, 1, 7, 6},
+				{tml::diagnostic_kind::invalid_unicode_escape_sequence, 1, 19, 18},
+				{tml::diagnostic_kind::unexpected_opening_curly_brace, 1, 20, 19}
+			}},
+			{"a \\", "a", {
+				{tml::diagnostic_kind::unterminated_string, 1, 4, 3}
+			}},
+			{R"(a \u12)", "a", {
+				{tml::diagnostic_kind::unterminated_string, 1, 7, 6}
+			}},
+			{"a \"b c", R"(a "b c")", {
+				{tml::diagnostic_kind::unterminated_string, 1, 7, 6}
+			}},
+			{"a{\"", R"(a{""})", {
+				{tml::diagnostic_kind::unterminated_string, 1, 4, 3},
+				{tml::diagnostic_kind::unclosed_children_list, 1, 4, 3}
+			}},
+			{"a R\"x(b c)", "a \"b c\"", {
+				{tml::diagnostic_kind::unterminated_string, 1, 11, 10}
+			}},
+			{"a \"\"\"b\nc\"\"", "a\"b\\nc\"", {
+				{tml::diagnostic_kind::unterminated_string, 2, 4, 10}
+			}},
+			{"a \"b\" /* c", R"(a b)", {
+				{tml::diagnostic_kind::unterminated_comment, 1, 11, 10}
+			}},
+			{"} {a} b{\"c", R"(""{a} b{c})", {
+				{tml::diagnostic_kind::unexpected_closing_curly_brace, 1, 1, 0},
+				{tml::diagnostic_kind::unexpected_opening_curly_brace, 1, 3, 2},
+				{tml::diagnostic_kind::unterminated_string, 1, 11, 10},
+				{tml::diagnostic_kind::unclosed_children_list, 1, 11, 10}
+			}},
+			// NOLINTEND(modernize-use-designated-initializers)
+		},
+		[](const auto& p){
+			diagnostics_collector diagnostics;
+
+			auto forest = tml::read(p.document, diagnostics);
+
+			tst::check_eq(tml::to_string(forest), tml::to_string(tml::read(p.recovered)), SL);
+
+			tst::check_eq(diagnostics.diagnostics.size(), p.diagnostics.size(), SL);
+			for(size_t i = 0; i != p.diagnostics.size(); ++i){
+				const auto& d = diagnostics.diagnostics[i];
+				const auto& e = p.diagnostics[i];
+				tst::check(d.kind == e.kind, SL) << "i = " << i << ", kind = " << unsigned(d.kind);
+				tst::check_eq(d.location.line, e.line, SL) << "i = " << i;
+				tst::check_eq(d.location.offset, e.offset, SL) << "i = " << i;
+				tst::check_eq(d.location.byte_offset, e.byte_offset, SL) << "i = " << i;
+			}
+		}
+	);
+});
+}
@@ -0,0 +1,64 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <fsif/native_file.hpp>
+
+#include "../../../src/tml/document.hpp"
+
+namespace{
+const tst::set set("document", [](tst::suite& suite){
+	suite.add("read_document_gives_same_result_as_read", [](){
+		auto expected = tml::read(fsif::native_file("tree_reading_data/test.tml"));
+
+		auto doc = tml::read_document(fsif::native_file("tree_reading_data/test.tml"));
+
+		tst::check(doc.to_forest() == expected, SL);
+	});
+
+	suite.add("nodes_are_accessible", [](){
+		auto doc = tml::read_document(R"(hello{world{!} "" how{}} are you)");
+
+		auto roots = doc.roots();
+		tst::check_eq(roots.size(), size_t(3), SL);
+
+		tst::check_eq(roots[0].value, std::string_view("hello"), SL);
+		tst::check_eq(roots[0].children.size(), size_t(3), SL);
+		tst::check_eq(roots[0].children[0].value, std::string_view("world"), SL);
+		tst::check_eq(roots[0].children[0].children.size(), size_t(1), SL);
+		tst::check_eq(roots[0].children[0].children[0].value, std::string_view("!"), SL);
+		tst::check(roots[0].children[1].value.empty(), SL);
+		tst::check_eq(roots[0].children[2].value, std::string_view("how"), SL);
+		tst::check(roots[0].children[2].children.empty(), SL);
+
+		tst::check_eq(roots[1].value, std::string_view("are"), SL);
+		tst::check(roots[1].children.empty(), SL);
+		tst::check_eq(roots[2].value, std::string_view("you"), SL);
+	});
+
+	suite.add("document_with_lots_of_nodes", [](){
+		std::string str;
+		for(size_t i = 0; i != 10000; ++i){
+			str.append("node").append(std::to_string(i)).append("{child{").append(std::string(i % 300, 'a')).append("}}\n");
+		}
+
+		auto doc = tml::read_document(str);
+
+		tst::check(doc.to_forest() == tml::read(str), SL);
+	});
+
+	suite.add("empty_document", [](){
+		auto doc = tml::read_document("");
+		tst::check(doc.roots().empty(), SL);
+	});
+
+	suite.add("malformed_document_should_throw", [](){
+		bool thrown = false;
+		try{
+			tml::read_document("hello{world}}");
+		}catch(std::invalid_argument&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+});
+}
@@ -0,0 +1,70 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <limits>
+
+#include "../../../src/tml/tree_ext.hpp"
+
+namespace{
+const tst::set set("extra_info_table", [](tst::suite& suite){
+	suite.add("table_gives_same_extra_info_as_vector", [](){
+		const std::string str = R"qwertyuiop(
+			hello"world!"
+			how {are you "doing"? R"qwe(raw)qwe"
+			}I'm okay{ /* comment */ """raw quotes""" {}}
+		)qwertyuiop";
+
+		std::vector<tml::extra_info> expected;
+		auto expected_wood = tml::read_ext(str, expected);
+
+		tml::extra_info_table table;
+		auto wood = tml::read_ext(str, table);
+
+		tst::check(wood == expected_wood, SL);
+		tst::check_eq(table.size(), expected.size(), SL);
+
+		for(size_t i = 0; i != expected.size(); ++i){
+			const auto& e = expected[i];
+			auto info = table[i];
+			tst::check_eq(info.location.line, e.location.line, SL) << "i = " << i;
+			tst::check_eq(info.location.offset, e.location.offset, SL) << "i = " << i;
+			tst::check_eq(info.location.byte_offset, e.location.byte_offset, SL) << "i = " << i;
+			tst::check_eq(info.length, e.length, SL) << "i = " << i;
+
+			auto loc = table.get_location(i);
+			tst::check_eq(loc.line, e.location.line, SL) << "i = " << i;
+			tst::check_eq(loc.offset, e.location.offset, SL) << "i = " << i;
+
+			auto flags = table.get_flags(i);
+			for(size_t f = 0; f != size_t(tml::flag::enum_size); ++f){
+				tst::check_eq(info.flags.get(tml::flag(f)), e.flags.get(tml::flag(f)), SL) << "i = " << i << ", f = " << f;
+				tst::check_eq(flags.get(tml::flag(f)), e.flags.get(tml::flag(f)), SL) << "i = " << i << ", f = " << f;
+			}
+		}
+
+		// reading again discards the previous contents
+		tml::read_ext("a b", table);
+		tst::check_eq(table.size(), size_t(2), SL);
+	});
+
+	suite.add("values_not_fitting_32_bits_are_saturated", [](){
+		constexpr auto max_size = std::numeric_limits<size_t>::max();
+		constexpr auto max_uint32 = size_t(std::numeric_limits<uint32_t>::max());
+
+		tml::extra_info info;
+		info.location.line = max_size;
+		info.location.offset = max_size;
+		info.location.byte_offset = max_size;
+		info.length = max_size;
+
+		tml::extra_info_table table;
+		table.push_back(info);
+
+		auto unpacked = table[0];
+		tst::check_eq(unpacked.location.line, max_uint32, SL);
+		tst::check_eq(unpacked.location.offset, max_uint32, SL);
+		tst::check_eq(unpacked.location.byte_offset, max_size, SL);
+		tst::check_eq(unpacked.length, max_uint32, SL);
+	});
+});
+}
@@ -0,0 +1,74 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <fsif/native_file.hpp>
+
+#include "../../../src/tml/flat_forest.hpp"
+
+namespace{
+const tst::set set("flat_forest", [](tst::suite& suite){
+	suite.add("read_flat_gives_same_result_as_read", [](){
+		auto expected = tml::read(fsif::native_file("tree_reading_data/test.tml"));
+
+		auto ff = tml::read_flat(fsif::native_file("tree_reading_data/test.tml"));
+
+		tst::check(ff.to_forest() == expected, SL);
+	});
+
+	suite.add("construct_from_forest", [](){
+		auto expected = tml::read(fsif::native_file("tree_reading_data/test.tml"));
+
+		tml::flat_forest ff(expected);
+
+		tst::check(ff.to_forest() == expected, SL);
+
+		auto read = tml::read_flat(fsif::native_file("tree_reading_data/test.tml"));
+		tst::check_eq(ff.get_strings(), read.get_strings(), SL);
+		tst::check_eq(ff.get_records().size(), read.get_records().size(), SL);
+	});
+
+	suite.add("nodes_are_accessible", [](){
+		auto ff = tml::read_flat(R"(hello{world{!} "" how{}} are you)");
+
+		auto roots = ff.roots();
+		tst::check_eq(roots.size(), size_t(3), SL);
+
+		auto i = roots.begin();
+		tst::check_eq((*i).value(), std::string_view("hello"), SL);
+		{
+			auto children = (*i).children();
+			tst::check_eq(children.size(), size_t(3), SL);
+
+			auto ci = children.begin();
+			tst::check_eq((*ci).value(), std::string_view("world"), SL);
+			tst::check_eq((*ci).children().size(), size_t(1), SL);
+			tst::check_eq((*(*ci).children().begin()).value(), std::string_view("!"), SL);
+			++ci;
+			tst::check((*ci).value().empty(), SL);
+			tst::check((*ci).children().empty(), SL);
+			++ci;
+			tst::check_eq((*ci).value(), std::string_view("how"), SL);
+			tst::check((*ci).children().empty(), SL);
+			++ci;
+			tst::check(ci == children.end(), SL);
+		}
+		++i;
+		tst::check_eq((*i).value(), std::string_view("are"), SL);
+		tst::check_eq((*i).get_index(), size_t(5), SL);
+		++i;
+		tst::check_eq((*i).value(), std::string_view("you"), SL);
+		++i;
+		tst::check(i == roots.end(), SL);
+	});
+
+	suite.add("malformed_document_should_throw", [](){
+		bool thrown = false;
+		try{
+			tml::read_flat("hello{world}}");
+		}catch(std::invalid_argument&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+});
+}
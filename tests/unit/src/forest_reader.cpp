@@ -0,0 +1,88 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <fsif/native_file.hpp>
+
+#include "../../../src/tml/forest_reader.hpp"
+
+namespace{
+const tst::set set("forest_reader", [](tst::suite& suite){
+	suite.add("repeated_reads_give_same_result_as_read", [](){
+		auto data = fsif::native_file("tree_reading_data/test.tml").load();
+		const std::string str(data.begin(), data.end());
+
+		auto expected = tml::read(str);
+
+		tml::forest_reader reader;
+
+		for(size_t i = 0; i != 3; ++i){
+			auto wood = reader.read(str);
+			tst::check(wood == expected, SL);
+
+			// read a document of different shape in between
+			auto other = reader.read("a{b{c d} \"some string which is long enough to be allocated on heap\"} e");
+			tst::check(other == tml::read("a{b{c d} \"some string which is long enough to be allocated on heap\"} e"), SL);
+
+			reader.recycle(std::move(other));
+			reader.recycle(std::move(wood));
+		}
+	});
+
+	suite.add("recycled_memory_is_reused", [](){
+		const std::string_view str = "\"some string which is long enough to be allocated on heap\"";
+
+		tml::forest_reader reader;
+
+		auto wood = reader.read(str);
+		tst::check_eq(wood.size(), size_t(1), SL);
+
+		const auto* forest_data = wood.data();
+		const auto* string_data = wood.front().value.string.data();
+
+		reader.recycle(std::move(wood));
+
+		auto reread = reader.read(str);
+		tst::check_eq(reread.size(), size_t(1), SL);
+		tst::check(reread.data() == forest_data, SL);
+		tst::check(reread.front().value.string.data() == string_data, SL);
+		tst::check(reread == tml::read(str), SL);
+	});
+
+	suite.add("reading_continues_after_malformed_document", [](){
+		tml::forest_reader reader;
+
+		for(auto doc : {"a{b{c", "a{b}}", "a{\"b"}){
+			bool thrown = false;
+			try{
+				reader.read(doc);
+			}catch(std::invalid_argument&){
+				thrown = true;
+			}
+			tst::check(thrown, SL) << "doc = " << doc;
+
+			auto wood = reader.read("a{b c}");
+			tst::check(wood == tml::read("a{b c}"), SL);
+		}
+	});
+
+	suite.add("parser_state_is_not_carried_over_from_malformed_document", [](){
+		tml::forest_reader reader;
+
+		for(auto doc : {"R\"(abc", "a \"b\\u12", "a /* comment", "\"\"\"raw quotes\"\""}){
+			bool thrown = false;
+			try{
+				reader.read(doc);
+			}catch(std::invalid_argument&){
+				thrown = true;
+			}
+			tst::check(thrown, SL) << "doc = " << doc;
+
+			// the escape sequence is only processed in case the raw string state of the failed document is discarded
+			auto wood = reader.read("\"\\nx\"");
+			tst::check(wood == tml::read("\"\\nx\""), SL) << "doc = " << doc;
+			tst::check_eq(wood.size(), size_t(1), SL);
+			tst::check_eq(wood.front().value.string, std::string("\nx"), SL);
+		}
+	});
+});
+}
@@ -0,0 +1,64 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include "../../../src/tml/line_index.hpp"
+#include "../../../src/tml/parser.hpp"
+
+namespace{
+const tst::set set("line_index", [](tst::suite& suite){
+	suite.add<std::pair<std::string_view, size_t>>(
+		"number_of_lines",
+		{
+			{"", 1},
+			{"hello", 1},
+			{"hello\n", 2},
+			{"\n\n", 3},
+			{"a\nb\r\nc", 3},
+		},
+		[](const auto& p){
+			tml::line_index index(utki::make_span(p.first));
+			tst::check_eq(index.num_lines(), p.second, SL);
+		}
+	);
+
+	suite.add<std::string_view>(
+		"location_is_same_as_reported_by_parser",
+		{
+			"hello",
+			"a b{c d}\n  e",
+			"a{\n\tb{c}\n\t\"d\ne\" f\n}\n\n g",
+			"bla R\"qwe(\nraw\nstring\n)qwe\" bla\n/* comment\n\n*/ bla {\n}",
+			// long line to exercise SIMD scanning
+			"a\nbla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla bla{\nb}\nc",
+		},
+		[](const auto& p){
+			struct listener : public tml::listener{
+				std::vector<tml::location> locations;
+
+				void on_string_parsed(std::string_view str, const tml::extra_info& info)override{
+					this->locations.push_back(info.location);
+				}
+
+				void on_children_parse_started(tml::location loc)override{
+					this->locations.push_back(loc);
+				}
+
+				void on_children_parse_finished(tml::location loc)override{
+					this->locations.push_back(loc);
+				}
+			} l;
+
+			tml::parse(utki::make_span(p), l);
+
+			tml::line_index index(utki::make_span(p));
+
+			for(const auto& loc : l.locations){
+				auto computed = index.get_location(loc.byte_offset);
+				tst::check_eq(computed.line, loc.line, SL);
+				tst::check_eq(computed.offset, loc.offset, SL);
+				tst::check_eq(computed.byte_offset, loc.byte_offset, SL);
+			}
+		}
+	);
+});
+}
@@ -2,6 +2,7 @@
 #include <tst/check.hpp>
 
 #include <deque>
+#include <functional>
 
 #include <fsif/native_file.hpp>
 
@@ -64,6 +65,122 @@ public:
 };
 }
 
+namespace{
+class recording_listener : public tml::listener{
+	void on_children_parse_finished(tml::location)override{
+		this->events.emplace_back("}");
+	}
+
+	void on_children_parse_started(tml::location)override{
+		this->events.emplace_back("{");
+	}
+
+	void on_string_parsed(std::string_view s, const tml::extra_info&)override{
+		this->events.emplace_back(s);
+
+		this->views_into_chunk.push_back(
+			!this->chunk.empty() && !s.empty() &&
+			std::less_equal<const char*>()(this->chunk.data(), s.data()) &&
+			std::less_equal<const char*>()(s.data() + s.size(), this->chunk.data() + this->chunk.size())
+		);
+	}
+
+public:
+	std::string_view chunk;
+
+	std::vector<std::string> events;
+
+	std::vector<bool> views_into_chunk;
+};
+}
+
+namespace{
+// listener which does not implement tml::listener interface, for use with tml::basic_parser
+class static_recording_listener{
+public:
+	std::vector<std::string> events;
+
+	void on_children_parse_finished(tml::location){
+		this->events.emplace_back("}");
+	}
+
+	void on_children_parse_started(tml::location){
+		this->events.emplace_back("{");
+	}
+
+	void on_string_parsed(std::string_view s, const tml::extra_info&){
+		this->events.emplace_back(s);
+	}
+};
+}
+
+namespace{
+class no_extra_info_recording_listener : public static_recording_listener{
+public:
+	constexpr static bool needs_extra_info = false;
+
+	std::vector<bool> raw_flags;
+
+	void on_string_parsed(std::string_view s, const tml::extra_info& info){
+		this->static_recording_listener::on_string_parsed(s, info);
+		this->raw_flags.push_back(info.flags.get(tml::flag::raw));
+	}
+};
+}
+
+namespace{
+// listener which takes ownership of the parsed strings
+class owning_recording_listener{
+public:
+	std::vector<std::string> events;
+
+	void on_children_parse_finished(tml::location){
+		this->events.emplace_back("}");
+	}
+
+	void on_children_parse_started(tml::location){
+		this->events.emplace_back("{");
+	}
+
+	void on_string_parsed(std::string&& s, const tml::extra_info&){
+		this->events.push_back(std::move(s));
+	}
+};
+}
+
+namespace{
+// listener which skips children of "skip" nodes and the rest of the children list after "stop" node
+class skipping_listener{
+public:
+	tml::basic_parser<skipping_listener>& parser;
+
+	std::vector<std::string> events;
+
+	skipping_listener(tml::basic_parser<skipping_listener>& parser) :
+		parser(parser)
+	{}
+
+	void on_children_parse_finished(tml::location){
+		this->events.emplace_back("}");
+	}
+
+	void on_children_parse_started(tml::location){
+		bool skip = this->events.back() == "skip";
+		this->events.emplace_back("{");
+		if(skip){
+			this->parser.skip_children();
+		}
+	}
+
+	void on_string_parsed(std::string_view s, const tml::extra_info&){
+		this->events.emplace_back(s);
+		if(s == "stop"){
+			this->parser.skip_children();
+		}
+	}
+};
+}
+
 namespace{
 const tst::set set("parser", [](auto& suite){
 	suite.add("parse", [](){
@@ -134,5 +251,386 @@ const tst::set set("parser", [](auto& suite){
 
 		tst::check(l.actions.size() == 0, SL);
 	});
+
+	suite.add("strings_without_escapes_refer_to_chunk_data", [](){
+		std::string_view data = "hello \"world\" child{child} R\"(raw)\" \"\"\"raw quotes\"\"\" esc\\ aped \"qu\\\"oted\" last";
+
+		recording_listener l;
+		l.chunk = data;
+
+		tml::parser p;
+		p.parse_data_chunk(utki::make_span(data), l);
+		p.end_of_data(l);
+
+		tst::check_eq(
+			l.events,
+			std::vector<std::string>{"hello", "world", "child", "{", "child", "}", "raw", "raw quotes", "esc aped", "qu\"oted", "last"},
+			SL
+		);
+
+		// the last string is reported from end_of_data(), when chunk data is not available anymore
+		tst::check_eq(
+			l.views_into_chunk,
+			std::vector<bool>{true, true, true, true, true, true, false, false, false},
+			SL
+		);
+	});
+
+	suite.template add<size_t>(
+		"parsing_in_chunks_gives_same_result",
+		{1, 2, 3, 5, 7, 16, 31, 33, 100},
+		[](const auto& chunk_size){
+			auto data = fsif::native_file("parser_data/test.tml").load();
+
+			recording_listener expected;
+			{
+				tml::parser p;
+				p.parse_data_chunk(utki::make_span(data), expected);
+				p.end_of_data(expected);
+			}
+
+			recording_listener l;
+			tml::parser p;
+			for(auto chunk = utki::make_span(data); !chunk.empty(); chunk = chunk.subspan(std::min(chunk_size, chunk.size()))){
+				p.parse_data_chunk(chunk.subspan(0, chunk_size), l);
+			}
+			p.end_of_data(l);
+
+			tst::check_eq(l.events, expected.events, SL);
+		}
+	);
+
+	suite.add("static_listener_gives_same_result", [](){
+		auto data = fsif::native_file("parser_data/test.tml").load();
+
+		const std::string str(data.begin(), data.end());
+
+		recording_listener expected;
+		tml::parse(utki::make_span(str), expected);
+
+		static_recording_listener l;
+		tml::parse(utki::make_span(str), l);
+
+		tst::check_eq(l.events, expected.events, SL);
+
+		static_recording_listener by_chunks;
+		tml::basic_parser<static_recording_listener> p;
+		for(auto chunk = utki::make_span(data); !chunk.empty(); chunk = chunk.subspan(std::min(size_t(7), chunk.size()))){
+			p.parse_data_chunk(chunk.subspan(0, 7), by_chunks);
+		}
+		p.end_of_data(by_chunks);
+
+		tst::check_eq(by_chunks.events, expected.events, SL);
+	});
+
+	suite.add("document_larger_than_index_window_is_parsed_as_expected", [](){
+		auto data = fsif::native_file("parser_data/test.tml").load();
+
+		// make the document long enough to span several index windows,
+		// shift the data by one char each time so that tokens cross the window and block boundaries in different places
+		std::string str;
+		for(size_t i = 0; str.size() < 0x30000; ++i){
+			str.append(i % 64, ' ');
+			str.append(data.begin(), data.end());
+			str.append("\n");
+		}
+
+		recording_listener expected;
+		{
+			tml::parser p;
+			for(char c : str){
+				p.parse_data_chunk(utki::make_span(&c, 1), expected);
+			}
+			p.end_of_data(expected);
+		}
+
+		static_recording_listener l;
+		tml::parse(utki::make_span(str), l);
+
+		tst::check_eq(l.events, expected.events, SL);
+	});
+
+	suite.template add<size_t>(
+		"skip_children",
+		{0, 1, 2, 3, 7},
+		[](const auto& chunk_size){
+			std::string str = R"(a{b c} skip{x{y "}" R"qq(})qq" /* } */ // }
+				z\{} """}"""} d{e stop f{g} "h}"}i)";
+
+			tml::basic_parser<skipping_listener> p;
+			skipping_listener l(p);
+
+			if(chunk_size == 0){
+				p.parse_data_chunk(utki::make_span(str), l);
+			}else{
+				for(auto chunk = utki::make_span(str); !chunk.empty(); chunk = chunk.subspan(std::min(chunk_size, chunk.size()))){
+					p.parse_data_chunk(chunk.subspan(0, chunk_size), l);
+				}
+			}
+			p.end_of_data(l);
+
+			tst::check_eq(
+				l.events,
+				std::vector<std::string>{"a", "{", "b", "c", "}", "skip", "{", "}", "d", "{", "e", "stop", "}", "i"},
+				SL
+			);
+		}
+	);
+
+	suite.add("skip_children_at_top_level_should_throw", [](){
+		std::string str = "a stop b";
+
+		tml::basic_parser<skipping_listener> p;
+		skipping_listener l(p);
+
+		bool thrown = false;
+		try{
+			p.parse_data_chunk(utki::make_span(str), l);
+		}catch(std::logic_error&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+
+	suite.add("unopened_curly_brace_should_throw", [](){
+		std::string str = "a{b}\n c}";
+
+		recording_listener l;
+
+		bool thrown = false;
+		try{
+			tml::parse(utki::make_span(str), l);
+		}catch(std::invalid_argument& e){
+			thrown = true;
+			tst::check_eq(std::string(e.what()), std::string("malformed tml: unopened curly brace encountered at 2:3"), SL);
+		}
+		tst::check(thrown, SL);
+
+		// the listener is not notified about the unopened curly brace
+		tst::check_eq(l.events, std::vector<std::string>{"a", "{", "b", "}", "c"}, SL);
+	});
+
+	suite.add("parsing_without_extra_info_gives_same_strings", [](){
+		auto data = fsif::native_file("parser_data/test.tml").load();
+		const std::string str(data.begin(), data.end());
+
+		static_assert(!tml::internal::listener_needs_extra_info<no_extra_info_recording_listener>::value);
+		static_assert(tml::internal::listener_needs_extra_info<static_recording_listener>::value);
+
+		static_recording_listener expected;
+		tml::parse(utki::make_span(str), expected);
+
+		no_extra_info_recording_listener l;
+		tml::parse(utki::make_span(str), l);
+
+		tst::check_eq(l.events, expected.events, SL);
+
+		std::string raw_str = "R\"qwe(\nraw\n)qwe\" \"\"\"\nraw quotes\n\"\"\" \"quoted\"";
+
+		no_extra_info_recording_listener raw_l;
+		tml::parse(utki::make_span(raw_str), raw_l);
+
+		tst::check_eq(raw_l.events, std::vector<std::string>{"raw", "raw quotes", "quoted"}, SL);
+		tst::check_eq(raw_l.raw_flags, std::vector<bool>{true, true, false}, SL);
+	});
+
+	suite.template add<size_t>(
+		"owning_listener_gives_same_strings",
+		{0, 1, 7},
+		[](const auto& chunk_size){
+			auto data = fsif::native_file("parser_data/test.tml").load();
+			std::string str(data.begin(), data.end());
+			str.append("\nR\"qwe(\r\nraw\r\n)qwe\" \"\"\"\nraw quotes\n\"\"\" \"esc\\\"aped\" R \"\\u0041\"");
+
+			static_assert(tml::internal::listener_takes_string_ownership<owning_recording_listener>::value);
+			static_assert(!tml::internal::listener_takes_string_ownership<static_recording_listener>::value);
+
+			static_recording_listener expected;
+			tml::parse(utki::make_span(str), expected);
+
+			owning_recording_listener l;
+			tml::basic_parser<owning_recording_listener> p;
+			if(chunk_size == 0){
+				p.parse_data_chunk(utki::make_span(str), l);
+			}else{
+				for(auto chunk = utki::make_span(str); !chunk.empty(); chunk = chunk.subspan(std::min(chunk_size, chunk.size()))){
+					p.parse_data_chunk(chunk.subspan(0, chunk_size), l);
+				}
+			}
+			p.end_of_data(l);
+
+			tst::check_eq(l.events, expected.events, SL);
+		}
+	);
+
+	suite.add("parsing_continues_from_restored_snapshot", [](){
+		// listener which records the strings along with their extra info
+		class listener{
+		public:
+			std::vector<std::string> events;
+
+			void on_children_parse_finished(tml::location loc){
+				this->events.push_back("} " + std::to_string(loc.line) + ":" + std::to_string(loc.offset));
+			}
+
+			void on_children_parse_started(tml::location loc){
+				this->events.push_back("{ " + std::to_string(loc.line) + ":" + std::to_string(loc.offset));
+			}
+
+			void on_string_parsed(std::string_view s, const tml::extra_info& info){
+				std::stringstream ss;
+				ss << s << " " << info.location.line << ":" << info.location.offset << " " << info.location.byte_offset << "+" << info.length;
+				for(size_t f = 0; f != size_t(tml::flag::enum_size); ++f){
+					ss << (info.flags.get(tml::flag(f)) ? "1" : "0");
+				}
+				this->events.push_back(ss.str());
+			}
+		};
+
+		std::string_view data = R"qwertyuiop(
+			a b{c d} "e\nf" /* comment */ g{}
+			// comment
+			R"qwe(raw
+			string)qwe" """raw quotes"""{h "" A}
+			i\ j
+		)qwertyuiop";
+
+		listener expected;
+		tml::parse(utki::make_span(data), expected);
+
+		for(size_t i = 0; i != data.size(); ++i){
+			listener l;
+
+			std::vector<char> serialized;
+			{
+				tml::basic_parser<listener> p;
+				p.parse_data_chunk(utki::make_span(data.substr(0, i)), l);
+				serialized = p.snapshot().serialize();
+			}
+
+			tml::basic_parser<listener> p;
+			p.restore(tml::parser_snapshot::deserialize(utki::make_span(serialized)));
+			p.parse_data_chunk(utki::make_span(data.substr(i)), l);
+			p.end_of_data(l);
+
+			tst::check_eq(l.events, expected.events, SL) << "i = " << i;
+		}
+	});
+
+	suite.add("deserializing_invalid_snapshot_should_throw", [](){
+		tml::basic_parser<static_recording_listener> p;
+		static_recording_listener l;
+		p.parse_data_chunk(utki::make_span(std::string_view("a{b \"c")), l);
+		auto serialized = p.snapshot().serialize();
+
+		for(size_t size : {size_t(0), size_t(3), size_t(10), serialized.size() - 1, serialized.size() + 1}){
+			auto data = serialized;
+			data.resize(size);
+
+			bool thrown = false;
+			try{
+				tml::parser_snapshot::deserialize(utki::make_span(data));
+			}catch(std::invalid_argument&){
+				thrown = true;
+			}
+			tst::check(thrown, SL) << "size = " << size;
+		}
+	});
+
+	suite.add("restoring_inconsistent_snapshot_should_throw", [](){
+		tml::basic_parser<static_recording_listener> p;
+		static_recording_listener l;
+		p.parse_data_chunk(utki::make_span(std::string_view("a{b \"\\u12")), l);
+		auto serialized = p.snapshot().serialize();
+
+		// The parser is in the middle of the unicode sequence. The serialized snapshot is
+		// signature, version, empty string, 4 characters sequence, sequence index, nesting level, skip depth etc.,
+		// the numbers are 64-bit little-endian.
+		constexpr size_t sequence_index_offset = 4 + 8 + 8 + (8 + 4);
+		constexpr size_t skip_depth_offset = sequence_index_offset + 8 + 8;
+
+		tst::check_eq(unsigned(serialized[sequence_index_offset]), 2u, SL);
+		tst::check_eq(unsigned(serialized[skip_depth_offset - 8]), 1u, SL);
+
+		for(auto corruption : std::vector<std::pair<size_t, char>>{
+			{sequence_index_offset, 4},
+			{sequence_index_offset, 100},
+			{skip_depth_offset, 2},
+		}){
+			auto data = serialized;
+			data[corruption.first] = corruption.second;
+
+			auto snapshot = tml::parser_snapshot::deserialize(utki::make_span(data));
+
+			tml::basic_parser<static_recording_listener> restored;
+			bool thrown = false;
+			try{
+				restored.restore(snapshot);
+			}catch(std::invalid_argument&){
+				thrown = true;
+			}
+			tst::check(thrown, SL) << "offset = " << corruption.first;
+		}
+
+		// the uncorrupted snapshot is restored fine
+		tml::basic_parser<static_recording_listener> restored;
+		restored.restore(tml::parser_snapshot::deserialize(utki::make_span(serialized)));
+	});
+
+	suite.add("restoring_snapshot_with_inconsistent_previous_state_should_throw", [](){
+		tml::basic_parser<static_recording_listener> p;
+		static_recording_listener l;
+		p.parse_data_chunk(utki::make_span(std::string_view("a // c")), l);
+		auto serialized = p.snapshot().serialize();
+
+		// The parser is in the single line comment, after it ends the parser returns to the previous state,
+		// which is the string parsed state. The serialized snapshot is signature, version, 1 character string,
+		// empty sequence, sequence index, nesting level, skip depth, current state, previous state etc.,
+		// the numbers are 64-bit little-endian.
+		constexpr size_t sequence_index_offset = 4 + 8 + (8 + 1) + 8;
+		constexpr size_t cur_state_offset = sequence_index_offset + 8 + 8 + 8;
+		constexpr size_t previous_state_offset = cur_state_offset + 8;
+
+		// single_line_comment and string_parsed states
+		tst::check_eq(unsigned(serialized[cur_state_offset]), 8u, SL);
+		tst::check_eq(unsigned(serialized[previous_state_offset]), 2u, SL);
+
+		for(const auto& corruption : std::vector<std::vector<std::pair<size_t, char>>>{
+			// unicode_sequence state with sequence index out of the sequence bounds
+			{{previous_state_offset, 5}, {sequence_index_offset, char(0xa0)}, {sequence_index_offset + 1, char(0x86)}, {sequence_index_offset + 2, 1}},
+			// unicode_sequence state with valid index, but the sequence is empty
+			{{previous_state_offset, 5}},
+			// raw_quotes_string_opening_sequence state
+			{{previous_state_offset, 13}},
+			// quoted_string state, the comments do not start from inside of a string
+			{{previous_state_offset, 3}},
+			// idle state with non-empty string
+			{{previous_state_offset, 1}},
+		}){
+			auto data = serialized;
+			for(const auto& c : corruption){
+				data[c.first] = c.second;
+			}
+
+			auto snapshot = tml::parser_snapshot::deserialize(utki::make_span(data));
+
+			tml::basic_parser<static_recording_listener> restored;
+			bool thrown = false;
+			try{
+				restored.restore(snapshot);
+			}catch(std::invalid_argument&){
+				thrown = true;
+			}
+			tst::check(thrown, SL) << "previous state = " << unsigned(data[previous_state_offset]);
+		}
+
+		// the uncorrupted snapshot is restored fine and the parser returns to the previous state after the comment
+		tml::basic_parser<static_recording_listener> restored;
+		restored.restore(tml::parser_snapshot::deserialize(utki::make_span(serialized)));
+		static_recording_listener restored_listener;
+		restored.parse_data_chunk(utki::make_span(std::string_view("\nX")), restored_listener);
+		restored.end_of_data(restored_listener);
+		tst::check_eq(restored_listener.events, std::vector<std::string>{"a", "X"}, SL);
+	});
 });
 }
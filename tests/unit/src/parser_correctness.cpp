@@ -18,6 +18,8 @@ const tst::set set("parser_correctness", [](tst::suite& suite){
 				{"a b c d e /f g", "/f"},
 				{"a b c d e /{z} g", "/"},
 				{"a b c d e //{z} g\nf g", "f"},
+				{"a b c d e /", "/"},
+				{"a b c d \"e\"/", "/"},
 			},
 			[](auto& p){
 				auto r = tml::read(p.first);
@@ -166,6 +168,35 @@ const tst::set set("parser_correctness", [](tst::suite& suite){
 			}
 		);
 	
+	// strings and comments longer than the block size of vectorized scanning
+	suite.add<std::pair<std::string, tml::forest>>(
+			"long_strings_are_parsed_as_expected",
+			{
+				{"abcdefghijklmnopqrstuvwxyz_0123456789_abcdefghijklmnopqrstuvwxyz_0123456789{child}",
+					{{"abcdefghijklmnopqrstuvwxyz_0123456789_abcdefghijklmnopqrstuvwxyz_0123456789", {{"child"}}}}},
+				{"abcdefghijklmnopqrstuvwxyz_0123456789_abcdefghijklmnopqrstuvwxyz_0123456789 next",
+					{{"abcdefghijklmnopqrstuvwxyz_0123456789_abcdefghijklmnopqrstuvwxyz_0123456789"}, {"next"}}},
+				{"abcdefghijklmnopqrstuvwxyz\\ 0123456789_abcdefghijklmnopqrstuvwxyz\\n0123456789\nnext",
+					{{"abcdefghijklmnopqrstuvwxyz 0123456789_abcdefghijklmnopqrstuvwxyz\n0123456789"}, {"next"}}},
+				{"\"abcdefghijklmnopqrstuvwxyz {0123456789}\t\r\n_abcdefghijklmnopqrstuvwxyz \\\"0123456789\"",
+					{{"abcdefghijklmnopqrstuvwxyz {0123456789}_abcdefghijklmnopqrstuvwxyz \"0123456789"}}},
+				{"\"\"\"abcdefghijklmnopqrstuvwxyz \"0123456789\"\" abcdefghijklmnopqrstuvwxyz\n0123456789\"\"\"",
+					{{"abcdefghijklmnopqrstuvwxyz \"0123456789\"\" abcdefghijklmnopqrstuvwxyz\n0123456789"}}},
+				{"R\"delim(abcdefghijklmnopqrstuvwxyz {0123456789} \"\"\"\nabcdefghijklmnopqrstuvwxyz 0123456789)delim\"",
+					{{"abcdefghijklmnopqrstuvwxyz {0123456789} \"\"\"\nabcdefghijklmnopqrstuvwxyz 0123456789"}}},
+				{"a // abcdefghijklmnopqrstuvwxyz {0123456789} \"abcdefghijklmnopqrstuvwxyz\" 0123456789\nb",
+					{{"a"}, {"b"}}},
+				{"a /* abcdefghijklmnopqrstuvwxyz {0123456789} * / \n\"abcdefghijklmnopqrstuvwxyz\" 0123456789 */b",
+					{{"a"}, {"b"}}},
+				{"a /* ** abcdefghijklmnopqrstuvwxyz ********************************** 0123456789 **/b",
+					{{"a"}, {"b"}}},
+			},
+			[](auto& p){
+				auto r = tml::read(p.first);
+				tst::check_eq(r, p.second, SL);
+			}
+		);
+
 	suite.add<std::string_view>(
 		"malformed_document_should_throw_exception",
 		{
@@ -174,7 +205,11 @@ const tst::set set("parser_correctness", [](tst::suite& suite){
 			"}",
 			" {qw}",
 			"asdf{{}}",
-			"afd{}{}"
+			"afd{}{}",
+			"\"\\uzzzz\"",
+			"\"\\u12zz\"",
+			"\"\\U0001f60z\"",
+			"a\\u12 b"
 		},
 		[](const auto& p){
 			bool thrown = false;
@@ -714,5 +714,52 @@ const tst::set set2("parser_location", [](tst::suite& suite){
 				tst::check_eq(l.info.location.offset, std::get<2>(p), SL);
 			}
 		);
+	suite.add<std::pair<std::string_view, std::string_view>>(
+			"token_byte_offset_and_length",
+			{
+				{"hello", "hello"},
+				{" hello ", "hello"},
+				{"bla{hello}", "hello"},
+				{R"x(bla "" hello{})x", "hello"},
+				{"bla\n  hello\nbla", "hello"},
+				{R"x(bla {child} "hello" bla)x", R"x("hello")x"},
+				{R"x(bla "he\u006C\u006Co"bla)x", R"x("he\u006C\u006Co")x"},
+				{R"x(pre"hello"post)x", R"x("hello")x"},
+				{"bla\n  R\"qwe(hello)qwe\" bla", R"x(R"qwe(hello)qwe")x"},
+				{"bla R\"qwe(\nhello\n)qwe\"", "R\"qwe(\nhello\n)qwe\""},
+				{R"x( R"hello")x", R"x("hello")x"},
+				{R"x(bla """hello"""{})x", R"x("""hello""")x"},
+				{"bla /*comment*/ \"\"\"\nhello\n\"\"\" bla", "\"\"\"\nhello\n\"\"\""},
+			},
+			[](const auto& p){
+				struct listener : public tml::listener{
+					bool string_parsed = false;
+					tml::extra_info info;
+					void on_string_parsed(std::string_view str, const tml::extra_info& info)override{
+						if(str == "hello"){
+							this->string_parsed = true;
+							this->info = info;
+						}
+					}
+
+					void on_children_parse_started(tml::location)override{}
+					void on_children_parse_finished(tml::location)override{}
+				};
+
+				// parse the whole document at once and byte by byte, the result must be the same
+				for(size_t chunk_size : {p.first.size(), size_t(1)}){
+					tml::parser parser;
+					listener l;
+
+					for(size_t i = 0; i < p.first.size(); i += chunk_size){
+						parser.parse_data_chunk(utki::make_span(p.first.substr(i, chunk_size)), l);
+					}
+					parser.end_of_data(l);
+
+					tst::check(l.string_parsed, SL);
+					tst::check_eq(p.first.substr(l.info.location.byte_offset, l.info.length), p.second, SL);
+				}
+			}
+		);
 });
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 #include <tst/set.hpp>
 #include <tst/check.hpp>
 
+#include <functional>
+
 #include "../../../src/tml/tree_ext.hpp"
 
 namespace{
@@ -83,5 +85,43 @@ const tst::set set("read_ext", [](auto& suite){
 		tst::check_eq(okay.value.string, std::string("okay"), SL);
 		tst::check(!okay.value.info.flags.get(tml::flag::first_on_line), SL);
 	});
+
+	suite.add("extra_info_side_table_matches_read_ext", [](){
+		const std::string str = R"qwertyuiop(
+			hello"world!"
+			how {are you "doing"? R"qwe(raw)qwe"
+			}I'm okay{ /* comment */ """raw quotes""" {}}
+		)qwertyuiop";
+
+		std::vector<tml::extra_info> info = {tml::extra_info()};
+		auto wood = tml::read_ext(str, info);
+
+		auto expected = tml::read_ext(str);
+
+		tst::check(wood == tml::to_non_ext(expected), SL);
+
+		// collect the expected nodes in pre-order
+		std::vector<const tml::tree_ext*> nodes;
+		std::function<void(const tml::forest_ext&)> collect = [&](const tml::forest_ext& f){
+			for(const auto& t : f){
+				nodes.push_back(&t);
+				collect(t.children);
+			}
+		};
+		collect(expected);
+
+		tst::check_eq(info.size(), nodes.size(), SL);
+
+		for(size_t i = 0; i != nodes.size(); ++i){
+			const auto& e = nodes[i]->value.info;
+			tst::check_eq(info[i].location.line, e.location.line, SL) << "i = " << i;
+			tst::check_eq(info[i].location.offset, e.location.offset, SL) << "i = " << i;
+			tst::check_eq(info[i].location.byte_offset, e.location.byte_offset, SL) << "i = " << i;
+			tst::check_eq(info[i].length, e.length, SL) << "i = " << i;
+			for(size_t f = 0; f != size_t(tml::flag::enum_size); ++f){
+				tst::check_eq(info[i].flags.get(tml::flag(f)), e.flags.get(tml::flag(f)), SL) << "i = " << i << ", f = " << f;
+			}
+		}
+	});
 });
 }
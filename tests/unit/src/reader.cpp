@@ -0,0 +1,114 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <fsif/native_file.hpp>
+
+#include "../../../src/tml/reader.hpp"
+#include "../../../src/tml/tree.hpp"
+
+namespace{
+// recursive-descent reading of the forest using pull reader
+tml::forest read_forest(tml::reader& r){
+	tml::forest ret;
+	for(;;){
+		const auto& e = r.next();
+		switch(e.type){
+			case tml::reader::event_type::string:
+				ret.emplace_back(e.string);
+				break;
+			case tml::reader::event_type::children_begin:
+				ret.back().children = read_forest(r);
+				break;
+			case tml::reader::event_type::children_end:
+			case tml::reader::event_type::end:
+				return ret;
+		}
+	}
+}
+}
+
+namespace{
+const tst::set set("reader", [](tst::suite& suite){
+	suite.add<size_t>(
+		"read_from_file_gives_same_result_as_read",
+		{1, 2, 3, 16, tml::reader::default_chunk_size},
+		[](const auto& chunk_size){
+			auto expected = tml::read(fsif::native_file("tree_reading_data/test.tml"));
+
+			fsif::native_file fi("tree_reading_data/test.tml");
+			tml::reader r(fi, chunk_size);
+
+			tst::check(read_forest(r) == expected, SL);
+			tst::check(r.next().type == tml::reader::event_type::end, SL);
+			tst::check(r.next().type == tml::reader::event_type::end, SL);
+		}
+	);
+
+	suite.add<size_t>(
+		"read_from_memory_gives_same_result_as_read",
+		{1, 2, 3, 16, tml::reader::default_chunk_size},
+		[](const auto& chunk_size){
+			auto data = fsif::native_file("tree_reading_data/test.tml").load();
+			std::string str(data.begin(), data.end());
+
+			auto expected = tml::read(str);
+
+			tml::reader r(utki::make_span(str), chunk_size);
+
+			tst::check(read_forest(r) == expected, SL);
+		}
+	);
+
+	suite.add("events_have_extra_info", [](){
+		std::string str = "hello{\n\"world\"}";
+		tml::reader r(utki::make_span(str));
+
+		auto e = r.next();
+		tst::check(e.type == tml::reader::event_type::string, SL);
+		tst::check_eq(e.string, std::string_view("hello"), SL);
+		tst::check_eq(e.info.location.line, size_t(1), SL);
+		tst::check(e.info.flags.get(tml::flag::curly_braces), SL);
+
+		e = r.next();
+		tst::check(e.type == tml::reader::event_type::children_begin, SL);
+
+		e = r.next();
+		tst::check(e.type == tml::reader::event_type::string, SL);
+		tst::check_eq(e.string, std::string_view("world"), SL);
+		tst::check_eq(e.info.location.line, size_t(2), SL);
+		tst::check(e.info.flags.get(tml::flag::quoted), SL);
+
+		e = r.next();
+		tst::check(e.type == tml::reader::event_type::children_end, SL);
+
+		e = r.next();
+		tst::check(e.type == tml::reader::event_type::end, SL);
+	});
+
+	suite.add("stop_reading_early", [](){
+		// the document is malformed at the end, but it is never parsed
+		std::string str = "first{a b c}\n";
+		str.append(tml::reader::default_chunk_size * 4, ' ');
+		str.append("}}}");
+
+		tml::reader r(utki::make_span(str));
+
+		auto e = r.next();
+		tst::check(e.type == tml::reader::event_type::string, SL);
+		tst::check_eq(e.string, std::string_view("first"), SL);
+	});
+
+	suite.add("malformed_document_should_throw", [](){
+		std::string str = "a{b}}";
+		tml::reader r(utki::make_span(str));
+
+		bool thrown = false;
+		try{
+			while(r.next().type != tml::reader::event_type::end){}
+		}catch(std::invalid_argument&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+});
+}
@@ -0,0 +1,142 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include "../../../src/tml/tree_ext.hpp"
+
+namespace{
+void check_same(const tml::forest_ext& a, const tml::forest_ext& b, utki::source_location loc){
+	tst::check_eq(a.size(), b.size(), loc);
+
+	for(size_t i = 0; i != a.size(); ++i){
+		const auto& x = a[i].value;
+		const auto& y = b[i].value;
+
+		tst::check_eq(x.string, y.string, loc);
+		tst::check_eq(x.info.location.line, y.info.location.line, loc) << "string = " << x.string;
+		tst::check_eq(x.info.location.offset, y.info.location.offset, loc) << "string = " << x.string;
+		tst::check_eq(x.info.location.byte_offset, y.info.location.byte_offset, loc) << "string = " << x.string;
+		tst::check_eq(x.info.length, y.info.length, loc) << "string = " << x.string;
+		for(size_t f = 0; f != size_t(tml::flag::enum_size); ++f){
+			tst::check_eq(x.info.flags.get(tml::flag(f)), y.info.flags.get(tml::flag(f)), loc) << "string = " << x.string << ", flag = " << f;
+		}
+
+		check_same(a[i].children, b[i].children, loc);
+	}
+}
+}
+
+namespace{
+const tst::set set("reparse_ext", [](tst::suite& suite){
+	suite.add<std::tuple<std::string, tml::text_edit>>(
+		"reparse_gives_same_result_as_read",
+		{
+			// NOLINTBEGIN(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+			{"a b c", {2, 1, "x y"}},
+			{"a b c", {0, 0, "x "}},
+			{"a b c", {5, 0, " d{e}"}},
+			{"a b c", {1, 1, ""}},
+			{"a\n b", {1, 1, ""}},
+			{"a\n b c", {1, 1, " "}},
+			{"a{b c d}\ne f", {4, 1, "x{y}"}},
+			{"a{b{c d} e}\nf g", {5, 0, "\n\n"}},
+			{"a{b c} d e\nf", {2, 1, "bbb"}},
+			{"a{b c}\nd{e}\n f", {3, 0, "\n\nx\n"}},
+			{"a{b c}\nd{e}\n f", {1, 0, "\n"}},
+			{"a{b c} d{e}", {5, 4, " d "}},
+			{"a{b}c{d e}", {6, 1, "\"x y\""}},
+			{"a R\"x(1)x\" b", {6, 1, "2\n3"}},
+			{"a \"\"\"1\"\"\" b{c}", {5, 1, "\n2\n"}},
+			{"a b c*/d", {2, 1, "/*"}},
+			{"a{b c}\nd", {1, 5, " b c"}},
+			{"/* comment */ a b", {3, 7, "other"}},
+			{"x{a{b c}} y", {6, 0, "}d{"}},
+			{"x{\n\ta{\n\t\tb\n\t\tc\n\t}\n}\ny", {12, 1, "cc\n\t\td"}},
+			{"a*/q\\\\ R\"(/)\"", {9, 2, "*"}},
+			{"/{*x}/*\"\"//aR\"(\"\t/*\U0001F600\t}/\n// \"qa)x\"{\"\"\"*/Ra", {19, 3, "}\t"}},
+			{"/ /{}((/", {0, 2, ""}},
+			{"R\"\"\"(/*/*\"\"\"{x}", {0, 0, "q "}},
+			{"R{}/{}", {0, 0, "b\"a b\""}},
+			// NOLINTEND(modernize-use-designated-initializers)
+		},
+		[](const auto& p){
+			const auto& text = std::get<0>(p);
+			const auto& edit = std::get<1>(p);
+
+			auto edited_text = text;
+			edited_text.replace(edit.offset, edit.length, edit.replacement);
+
+			auto expected = tml::read_ext(edited_text);
+
+			auto wood = tml::read_ext(text);
+			tml::reparse_ext(wood, edited_text, edit);
+
+			check_same(wood, expected, SL);
+		}
+	);
+
+	suite.add("only_nodes_enclosing_edit_are_parsed_again", [](){
+		// the strings are long enough to be allocated on heap, so that their data pointers identify the node objects
+		std::string text =
+			"first_node_with_a_long_name{child_node_with_a_long_name}\n"
+			"second_node_with_a_long_name{x y z}\n"
+			"third_node_with_a_long_name{child_node_with_a_long_name}";
+		auto wood = tml::read_ext(text);
+		tst::check_eq(wood.size(), size_t(3), SL);
+
+		std::vector<const char*> untouched = {
+			wood[0].value.string.data(),
+			wood[0].children[0].value.string.data(),
+			wood[1].value.string.data(),
+			wood[2].value.string.data(),
+			wood[2].children[0].value.string.data(),
+		};
+
+		// replace "y" by "w", only the "x y" range of the children of the second node is to be parsed again
+		auto offset = text.find(" y ") + 1;
+		text[offset] = 'w';
+
+		// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+		tml::reparse_ext(wood, text, {offset, 1, "w"});
+
+		check_same(wood, tml::read_ext(text), SL);
+
+		std::vector<const char*> after = {
+			wood[0].value.string.data(),
+			wood[0].children[0].value.string.data(),
+			wood[1].value.string.data(),
+			wood[2].value.string.data(),
+			wood[2].children[0].value.string.data(),
+		};
+		tst::check(after == untouched, SL) << "nodes outside of the edited range were parsed again";
+	});
+
+	suite.add("series_of_edits", [](){
+		std::string text = "a{\n\tb{c d}\n\te\n}\nf{g}\nh\n";
+		auto wood = tml::read_ext(text);
+
+		std::vector<std::pair<size_t, std::string>> insertions = {
+			{8, " "},
+			{9, "x"},
+			{0, "z"},
+			{1, "\n"},
+			{20, "\"\""},
+			{21, "q"},
+			{17, "{}"},
+			{18, "r"},
+		};
+
+		for(const auto& e : insertions){
+			text.insert(e.first, e.second);
+
+			tml::reparse_ext(
+				wood,
+				text,
+				// NOLINTNEXTLINE(modernize-use-designated-initializers, "needs C++20, but we use C++17")
+				{e.first, 0, e.second}
+			);
+
+			check_same(wood, tml::read_ext(text), SL);
+		}
+	});
+});
+}
@@ -38,5 +38,31 @@ const tst::set set("to_non_ext", [](auto& suite){
                 tst::check_eq(out, expected, SL);
             }
         );
+
+    suite.template add<std::string>(
+            "forest_to_non_ext_consuming",
+            {
+                "hello world!",
+                "hello{world!{how \"are\" you?}} world!",
+                "hello{world!{how \"are\" you?}} world!{bla{one two three} bla bla}",
+            },
+            [](auto& p){
+                auto in = tml::read_ext(p);
+                auto expected = tml::read(p);
+
+                auto out = tml::to_non_ext(std::move(in));
+
+                tst::check_eq(out, expected, SL);
+            }
+        );
+
+    suite.add("tree_to_non_ext_consuming", [](){
+        auto in = tml::read_ext("hello{world!{how \"are\" you?}}");
+        auto expected = tml::read("hello{world!{how \"are\" you?}}");
+
+        auto out = tml::to_non_ext(std::move(in[0]));
+
+        tst::check_eq(out, expected[0], SL);
+    });
 });
 }
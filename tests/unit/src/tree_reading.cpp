@@ -2,7 +2,9 @@
 #include <tst/check.hpp>
 
 #include <fsif/native_file.hpp>
+#include <fsif/span_file.hpp>
 
+#include "../../../src/tml/parser.hpp"
 #include "../../../src/tml/tree.hpp"
 
 namespace{
@@ -192,5 +194,188 @@ const tst::set set("tree_reading", [](tst::suite& suite){
 			tst::check(cloned.size() == roots.size(), SL);
 		}
 	});
+
+	suite.add("read_mapped", [](){
+		auto expected = tml::read(fsif::native_file("tree_reading_data/test.tml"));
+
+		auto roots = tml::read_mapped("tree_reading_data/test.tml");
+
+		tst::check_eq(roots, expected, SL);
+	});
+
+	suite.add("read_mapped_non_existing_file_should_throw", [](){
+		bool thrown = false;
+		try{
+			tml::read_mapped("tree_reading_data/non_existing.tml");
+		}catch(std::exception&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+
+	suite.add<size_t>(
+		"read_by_chunks_of_given_size",
+		{1, 2, 3, 16, 0x4ff},
+		[](const auto& chunk_size){
+			auto expected = tml::read(fsif::native_file("tree_reading_data/test.tml"));
+
+			auto data = fsif::native_file("tree_reading_data/test.tml").load();
+			const fsif::span_file fi(utki::make_span(data));
+
+			class listener : public tml::listener{
+			public:
+				tml::forest roots;
+				std::vector<tml::forest> stack;
+
+				void on_string_parsed(std::string_view str, const tml::extra_info&)override{
+					this->roots.emplace_back(str);
+				}
+
+				void on_children_parse_started(tml::location)override{
+					this->stack.push_back(std::move(this->roots));
+				}
+
+				void on_children_parse_finished(tml::location)override{
+					this->stack.back().back().children = std::move(this->roots);
+					this->roots = std::move(this->stack.back());
+					this->stack.pop_back();
+				}
+			} l;
+
+			tml::parse(fi, l, chunk_size);
+
+			tst::check_eq(l.roots, expected, SL);
+		}
+	);
+
+	suite.add<unsigned>(
+		"read_parallel_gives_same_result_as_read",
+		{0, 1, 2, 3, 8, 16},
+		[](const auto& thread_count){
+			auto test_tml = fsif::native_file("tree_reading_data/test.tml").load();
+
+			// document with lots of top-level nodes, also some lines inside of strings, comments and
+			// children blocks look like the beginnings of top-level nodes
+			std::string str;
+			for(size_t i = 0; str.size() < 0x100000; ++i){
+				str.append("record").append(std::to_string(i)).append("{\nid{").append(std::to_string(i)).append("}\n");
+				str.append("text{\"multi\nline string\n\"}\n");
+				str.append("raw{R\"qwe(\nlooks_like{top level}\n)qwe\"}\n");
+				str.append("}\n");
+				str.append("/*\nlooks_like_top_level\n*/\n");
+				str.append("flat_string").append(std::to_string(i)).append("\n");
+				if(i % 100 == 0){
+					str.append(test_tml.begin(), test_tml.end());
+					str.append("\n");
+				}
+			}
+
+			auto expected = tml::read(str);
+
+			auto result = tml::read_parallel(utki::make_span(str), thread_count);
+
+			tst::check_eq(result.size(), expected.size(), SL);
+			tst::check(result == expected, SL);
+		}
+	);
+
+	suite.add<std::string>(
+		"read_presized_gives_same_result_as_read",
+		{
+			"",
+			"a",
+			"a{} b{c{}} d",
+			"a{b c{d e f} g{h}} \"i\" R\"qwe(j)qwe\" /* k */ l{m{n{o}}}",
+			[](){
+				// wide node lists
+				std::string str = "wide{";
+				for(size_t i = 0; i != 100000; ++i){
+					str.append("n").append(std::to_string(i)).append(i % 1000 == 0 ? "{x y z}\n" : " ");
+				}
+				str.append("}");
+				return str;
+			}(),
+		},
+		[](const auto& p){
+			auto expected = tml::read(p);
+
+			auto result = tml::read_presized(p);
+
+			tst::check_eq(result.size(), expected.size(), SL);
+			tst::check(result == expected, SL);
+			tst::check_eq(result.capacity(), result.size(), SL);
+		}
+	);
+
+	suite.add("read_presized_test_document", [](){
+		auto data = fsif::native_file("tree_reading_data/test.tml").load();
+		const std::string str(data.begin(), data.end());
+
+		tst::check(tml::read_presized(str) == tml::read(str), SL);
+	});
+
+	suite.add<std::string_view>(
+		"read_presized_malformed_document_should_throw",
+		{
+			"a{b",
+			"a}",
+			"a{b}}",
+			"{a}",
+			"a \"b",
+		},
+		[](const auto& p){
+			bool thrown = false;
+			try{
+				tml::read_presized(p);
+			}catch(std::invalid_argument&){
+				thrown = true;
+			}
+			tst::check(thrown, SL);
+		}
+	);
+
+	suite.add<std::pair<std::string_view, std::string_view>>(
+		"malformed_document_error_should_report_line",
+		{
+			{"a\nb\nc}", "3:2"},
+			{"a{\n}\n\n }", "4:2"},
+			{"a{}\n\n{b}", "line: 3"},
+			{"a\nb\n\"\\uzzzz\"", "line: 3"},
+		},
+		[](const auto& p){
+			for(bool from_file : {false, true}){
+				std::string message;
+				try{
+					if(from_file){
+						tml::read(fsif::span_file(utki::to_uint8_t(utki::make_span(p.first))));
+					}else{
+						tml::read(p.first);
+					}
+				}catch(std::invalid_argument& e){
+					message = e.what();
+				}
+				tst::check(message.find(p.second) != std::string::npos, SL) << "message = " << message;
+			}
+		}
+	);
+
+	suite.add("read_parallel_malformed_document_should_throw", [](){
+		std::string str;
+		for(size_t i = 0; str.size() < 0x100000; ++i){
+			str.append("record{id{").append(std::to_string(i)).append("}}\n");
+		}
+		str.append("unopened}\n");
+		for(size_t i = 0; i != 100; ++i){
+			str.append("record{id{").append(std::to_string(i)).append("}}\n");
+		}
+
+		bool thrown = false;
+		try{
+			tml::read_parallel(utki::make_span(str), 4);
+		}catch(std::invalid_argument&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
 });
 }
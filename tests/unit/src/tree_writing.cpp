@@ -2,6 +2,7 @@
 #include <tst/check.hpp>
 
 #include <regex>
+#include <sstream>
 
 #include <fsif/native_file.hpp>
 #include <fsif/vector_file.hpp>
@@ -64,5 +65,58 @@ const tst::set set("tree_writing", [](tst::suite& suite){
 		decltype(files)(files),
 		make_test_proc<true>()
 	);
+
+	suite.add<std::string>(
+		"write_to_ostream",
+		decltype(files)(files),
+		[](const std::string& p){
+			auto roots = tml::read(fsif::native_file(data_dir + p));
+
+			std::stringstream ss;
+			tml::write(roots, ss);
+
+			auto expected = fsif::native_file(data_dir + p + ".formatted").load();
+
+			tst::check_eq(ss.str(), std::string(expected.begin(), expected.end()), SL);
+		}
+	);
+
+	suite.add<size_t>(
+		"write_with_given_buffer_size",
+		{1, 2, 3, 7, 100},
+		[](const auto& buffer_size){
+			auto roots = tml::read(fsif::native_file(data_dir + "sample1.tml"));
+
+			tml::string_sink s;
+			tml::write(roots, s, tml::formatting::normal, buffer_size);
+
+			auto expected = fsif::native_file(data_dir + "sample1.tml.formatted").load();
+
+			tst::check_eq(s.str, std::string(expected.begin(), expected.end()), SL);
+		}
+	);
+
+	suite.add("strings_with_special_characters_are_written_as_expected", [](){
+		std::string long_str(100, 'a');
+		std::string long_str_with_escapes = long_str + "\t\n\\\"" + long_str + "\"";
+
+		tml::forest roots = {
+			tml::tree(long_str),
+			tml::tree(long_str + " " + long_str),
+			tml::tree(long_str + "{"),
+			tml::tree(long_str_with_escapes),
+			tml::tree("\"", {tml::tree("\t")}),
+		};
+
+		auto str = tml::to_string(roots);
+
+		tst::check_eq(
+			str,
+			long_str + "\"" + long_str + " " + long_str + "\"\"" + long_str + "{\"\"" + long_str + "\\t\\n\\\\\\\"" + long_str + "\\\"\"\"\\\"\"{\"\\t\"}",
+			SL
+		);
+
+		tst::check(tml::read(str) == roots, SL);
+	});
 });
 }
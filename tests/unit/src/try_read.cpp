@@ -0,0 +1,55 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include "../../../src/tml/tree.hpp"
+
+namespace{
+const tst::set set("try_read", [](tst::suite& suite){
+	suite.add<std::string_view>(
+		"well_formed_document_is_read",
+		{
+			"",
+			"a",
+			"a b{c d{e}} \"f\" R\"qwe(raw)qwe\" /* comment */ g",
+			"a{b} // comment",
+		},
+		[](const auto& p){
+			auto result = tml::try_read(p);
+
+			tst::check(bool(result), SL);
+			tst::check(!result.error.has_value(), SL);
+			tst::check(result.wood == tml::read(p), SL);
+		}
+	);
+
+	suite.add("malformed_document_reports_first_problem", [](){
+		auto result = tml::try_read("a{b}\nc}}");
+
+		tst::check(!result, SL);
+		tst::check(result.wood.empty(), SL);
+		tst::check(result.error.has_value(), SL);
+		tst::check(result.error->kind == tml::diagnostic_kind::unexpected_closing_curly_brace, SL);
+		tst::check_eq(result.error->location.line, size_t(2), SL);
+		tst::check_eq(result.error->location.offset, size_t(2), SL);
+		tst::check_eq(result.error->location.byte_offset, size_t(6), SL);
+	});
+
+	suite.add<std::pair<std::string_view, tml::diagnostic_kind>>(
+		"malformed_document_reports_problem_kind",
+		{
+			{"{", tml::diagnostic_kind::unexpected_opening_curly_brace},
+			{"a{b", tml::diagnostic_kind::unclosed_children_list},
+			{"a \"b", tml::diagnostic_kind::unterminated_string},
+			{"a /* comment", tml::diagnostic_kind::unterminated_comment},
+			{R"(a "\uzzzz")", tml::diagnostic_kind::invalid_unicode_escape_sequence},
+		},
+		[](const auto& p){
+			auto result = tml::try_read(p.first);
+
+			tst::check(!result, SL);
+			tst::check(result.error.has_value(), SL);
+			tst::check(result.error->kind == p.second, SL);
+		}
+	);
+});
+}
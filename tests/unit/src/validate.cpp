@@ -0,0 +1,66 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <fsif/native_file.hpp>
+
+#include "../../../src/tml/parser.hpp"
+
+namespace{
+const tst::set set("validate", [](tst::suite& suite){
+	suite.add<std::string_view>(
+		"well_formed_document_is_valid",
+		{
+			"",
+			"a b c",
+			"a{b{c d} e} f{}",
+			R"(a "b\né{}" "" c)",
+			"R\"qwe(raw {string)qwe\" \"\"\"raw quotes}\"\"\"",
+			"a /* comment { */ b // comment }\nc",
+			"a\\ b\\{ c",
+			"/",
+			"R\"0123456789abcdefghij(raw string)0123456789abcdefghij\"",
+			"R\"0123456789abcdefghij\\\"",
+		},
+		[](const auto& p){
+			tst::check(tml::validate(utki::make_span(p)), SL);
+		}
+	);
+
+	suite.add("test_document_is_valid", [](){
+		auto data = fsif::native_file("parser_data/test.tml").load();
+		const std::string str(data.begin(), data.end());
+
+		tst::check(tml::validate(utki::make_span(str)), SL);
+	});
+
+	suite.add<std::string_view>(
+		"malformed_document_is_invalid",
+		{
+			"{}",
+			"{",
+			"}",
+			" {qw}",
+			"asdf{{}}",
+			"afd{}{}",
+			"a{b",
+			"a{b{}",
+			"a} b",
+			"a{b}}",
+			"a \"b",
+			"a{\"b}",
+			"R\"qwe(raw string)qw\"",
+			"\"\"\"raw quotes\"\"",
+			"a /* comment",
+			R"(a "\uzzzz")",
+			R"(a "\u12zz")",
+			R"(a "\U0001f60z")",
+			R"(a\u12 b)",
+			R"(a \uzzzz b)",
+			R"(\u00eZ)",
+		},
+		[](const auto& p){
+			tst::check(!tml::validate(utki::make_span(p)), SL);
+		}
+	);
+});
+}
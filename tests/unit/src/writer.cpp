@@ -0,0 +1,147 @@
+#include <tst/set.hpp>
+#include <tst/check.hpp>
+
+#include <fsif/native_file.hpp>
+
+#include "../../../src/tml/parser.hpp"
+#include "../../../src/tml/writer.hpp"
+
+namespace{
+const std::string data_dir = "tree_writing_data/";
+}
+
+namespace{
+const tst::set set("writer", [](tst::suite& suite){
+	suite.add<std::pair<std::string, tml::formatting>>(
+		"reformat_by_piping_parser_to_writer",
+		{
+			{"sample1.tml.formatted", tml::formatting::normal},
+			{"sample1.tml.unformatted", tml::formatting::minimal},
+			{"sample2.tml.formatted", tml::formatting::normal},
+			{"sample2.tml.unformatted", tml::formatting::minimal},
+		},
+		[](const auto& p){
+			auto expected = fsif::native_file(data_dir + p.first).load();
+
+			std::string file_name = p.first.substr(0, p.first.find(".tml") + 4);
+
+			tml::string_sink s;
+			tml::writer w(s, p.second);
+
+			tml::parse(fsif::native_file(data_dir + file_name), w);
+			w.finish();
+
+			tst::check_eq(s.str, std::string(expected.begin(), expected.end()), SL);
+		}
+	);
+
+	suite.add<std::pair<std::string, std::string>>(
+		"write_formatted",
+		{
+			{"a b c", "a\nb\nc\n"},
+			{"a{} b", "a\nb\n"},
+			{"a{b}", "a{b}\n"},
+			{"a{b{}}", "a{b}\n"},
+			{"a{R}", "a{R }\n"},
+			{"R", "R \n"},
+			{"a{b c}", "a{\n\tb\n\tc\n}\n"},
+			{"a{b{c}}", "a{\n\tb{c}\n}\n"},
+			{"a{b{c d}}", "a{\n\tb{\n\t\tc\n\t\td\n\t}\n}\n"},
+			{R"(a{"" "b c"} "")", "a{\n\t\"\"\n\t\"b c\"\n}\n\"\"\n"},
+		},
+		[](const auto& p){
+			tml::string_sink s;
+			tml::writer w(s);
+
+			tml::parse(utki::make_span(p.first), w);
+			w.finish();
+
+			tst::check_eq(s.str, p.second, SL);
+		}
+	);
+
+	suite.add<std::pair<std::string, std::string>>(
+		"write_minimal",
+		{
+			{"a b c", "a b c"},
+			{"a{} b", "a b"},
+			{"a{b c} d", "a{b c}d"},
+			{"a{b{c}}", "a{b{c}}"},
+			{R"(R "b c")", R"(R "b c")"},
+			{R"(a "" b)", R"(a""b)"},
+		},
+		[](const auto& p){
+			tml::string_sink s;
+			tml::writer w(s, tml::formatting::minimal);
+
+			tml::parse(utki::make_span(p.first), w);
+			w.finish();
+
+			tst::check_eq(s.str, p.second, SL);
+		}
+	);
+
+	suite.add("write_node_by_node", [](){
+		tml::string_sink s;
+		tml::writer w(s);
+
+		w.string("hello");
+		w.begin_children();
+		w.string("world");
+		w.begin_children();
+		w.string("!");
+		w.end_children();
+		w.string("how");
+		w.end_children();
+		w.string("are you?");
+		w.finish();
+
+		tst::check_eq(s.str, std::string("hello{\n\tworld{!}\n\thow\n}\n\"are you?\"\n"), SL);
+	});
+
+	suite.add("begin_children_without_node_should_throw", [](){
+		tml::string_sink s;
+		tml::writer w(s);
+
+		bool thrown = false;
+		try{
+			w.begin_children();
+		}catch(std::logic_error&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+
+	suite.add("end_children_without_begin_should_throw", [](){
+		tml::string_sink s;
+		tml::writer w(s);
+
+		w.string("a");
+
+		bool thrown = false;
+		try{
+			w.end_children();
+		}catch(std::logic_error&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+
+	suite.add("finish_with_unended_children_should_throw", [](){
+		tml::string_sink s;
+		tml::writer w(s);
+
+		w.string("a");
+		w.begin_children();
+		w.string("b");
+
+		bool thrown = false;
+		try{
+			w.finish();
+		}catch(std::logic_error&){
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+});
+}